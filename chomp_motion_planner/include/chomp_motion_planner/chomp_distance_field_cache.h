@@ -0,0 +1,97 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#pragma once
+
+#include <moveit/collision_detection/world.h>
+#include <moveit/collision_distance_field/collision_env_hybrid.h>
+#include <moveit/planning_scene/planning_scene.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace chomp
+{
+/**
+ * \brief Keeps a hybrid collision environment alive across CHOMP plans.
+ *
+ * The cached environment is built from the robot model and a world of its own, so it shares no state with the
+ * planning scene. Its world is synchronized with the planning scene on every plan. Only objects whose shapes or poses
+ * changed are replaced, and the octomap is split into regions so that an octomap update only touches the voxels of the
+ * regions that actually changed. Consecutive plans in a static cell therefore reuse the distance field instead of
+ * constructing it again.
+ *
+ * The cache is thread safe. Concurrent plans in an unchanged scene share the cached environment, while a plan in a
+ * changed scene gets a new one if another plan still holds the old one.
+ */
+class ChompDistanceFieldCache
+{
+public:
+  ChompDistanceFieldCache() = default;
+
+  /**
+   * Synchronizes the cached environment with the world of planning_scene, creating it on first use
+   * @return the cached environment, which stays valid and unchanged as long as the caller holds it, or nullptr if the
+   * active collision detector of the scene is not hybrid
+   */
+  std::shared_ptr<const collision_detection::CollisionEnvHybrid>
+  getCollisionEnv(const planning_scene::PlanningSceneConstPtr& planning_scene);
+
+  /// drops the cached environment, the next call to getCollisionEnv() builds the distance field from scratch
+  void clear();
+
+private:
+  /// \brief whether the cached environment already matches the scene, given the region hashes of its octomap
+  bool isSynchronized(const collision_detection::CollisionEnvHybrid& scene_env,
+                      const collision_detection::World& scene_world,
+                      const std::unordered_map<std::uint64_t, std::size_t>& region_hashes) const;
+  void syncObject(const collision_detection::World::Object& object);
+  void syncOctomap(const collision_detection::World::Object& object,
+                   std::unordered_map<std::uint64_t, std::size_t>& region_hashes);
+  std::string getOctomapRegionId(std::uint64_t region) const;
+
+  moveit::core::RobotModelConstPtr robot_model_;
+  collision_detection::WorldPtr world_;
+  std::shared_ptr<collision_detection::CollisionEnvHybrid> env_;
+  std::mutex mutex_;
+
+  std::map<std::string, std::size_t> object_revisions_;  // hash of the shapes and poses of each synchronized object
+  std::unordered_map<std::uint64_t, std::size_t> octomap_region_hashes_;  // hash of the occupied leaves of each
+                                                                         // octomap region
+};
+}  // namespace chomp
@@ -53,9 +53,23 @@ namespace chomp
 class ChompOptimizer
 {
 public:
+  /**
+   * Reasons for which optimize() stops iterating
+   */
+  enum TerminationReason
+  {
+    NOT_STARTED,         /// optimize() has not been called yet
+    MAX_ITERATIONS,      /// max_iterations_ was reached
+    TIME_LIMIT,          /// planning_time_limit_ was exceeded
+    COLLISION_FREE,      /// a collision free path was found
+    COST_PLATEAU,        /// the relative cost improvement over the convergence window fell below tolerance
+    GRADIENT_CONVERGED,  /// the norm of the cost gradient fell below tolerance
+  };
+
   ChompOptimizer(ChompTrajectory* trajectory, const planning_scene::PlanningSceneConstPtr& planning_scene,
                  const std::string& planning_group, const ChompParameters* parameters,
-                 const moveit::core::RobotState& start_state);
+                 const moveit::core::RobotState& start_state,
+                 const collision_detection::CollisionEnvHybrid* hy_env = nullptr);
 
   virtual ~ChompOptimizer();
 
@@ -80,6 +94,27 @@ public:
     return is_collision_free_;
   }
 
+  /**
+   * @return the cost of the best trajectory found by the last call to optimize()
+   */
+  double getBestCost() const
+  {
+    return best_group_trajectory_cost_;
+  }
+
+  /**
+   * @return the reason why the last call to optimize() stopped iterating
+   */
+  TerminationReason getTerminationReason() const
+  {
+    return termination_reason_;
+  }
+
+  /**
+   * @return a human readable description of a termination reason
+   */
+  static const char* getTerminationReasonString(TerminationReason reason);
+
 private:
   inline double getPotential(double field_distance, double radius, double clearance)
   {
@@ -100,10 +135,6 @@ private:
       return -d + 0.5 * clearance;  // linearly increase, starting from 0.5 * clearance
     }
   }
-  template <typename Derived>
-  void getJacobian(int trajectoryPoint, Eigen::Vector3d& collision_point_pos, std::string& jointName,
-                   Eigen::MatrixBase<Derived>& jacobian) const;
-
   // void getRandomState(const moveit::core::RobotState& currentState,
   //                     const std::string& group_name,
   //                     Eigen::VectorXd& state_vec);
@@ -145,11 +176,15 @@ private:
   std::vector<EigenSTL::vector_Vector3d> collision_point_potential_gradient_;
   std::vector<EigenSTL::vector_Vector3d> joint_axes_;
   std::vector<EigenSTL::vector_Vector3d> joint_positions_;
+
+  std::vector<std::vector<int> > collision_point_parent_joints_;  /**< indices of the joints that move each collision
+                                                                     point, i.e. its non-zero Jacobian columns */
   Eigen::MatrixXd group_trajectory_backup_;
   Eigen::MatrixXd best_group_trajectory_;
   double best_group_trajectory_cost_;
   int last_improvement_iteration_;
   unsigned int num_collision_free_iterations_;
+  TerminationReason termination_reason_;
 
   // HMC stuff:
   Eigen::MatrixXd momentum_;
@@ -170,9 +205,8 @@ private:
 
   // temporary variables for all functions:
   Eigen::VectorXd smoothness_derivative_;
-  Eigen::MatrixXd jacobian_;
-  Eigen::MatrixXd jacobian_pseudo_inverse_;
-  Eigen::MatrixXd jacobian_jacobian_tranpose_;
+  Eigen::Matrix<double, 3, Eigen::Dynamic> jacobian_;  // non-zero columns, sized for the most parent joints
+  Eigen::VectorXd joint_gradient_;                      // collision gradient of the parent joints
   Eigen::VectorXd random_state_;
   Eigen::VectorXd joint_state_velocities_;
 
@@ -199,7 +233,10 @@ private:
   void initialize();
   void calculateSmoothnessIncrements();
   void calculateCollisionIncrements();
+  void addSparseCollisionIncrement(int trajectory_point, int collision_point,
+                                   const Eigen::Vector3d& cartesian_gradient);
   void calculateTotalIncrements();
+  double getCostGradientNorm() const;
   void performForwardKinematics();
   void addIncrementsToTrajectory();
   void updateFullTrajectory();
@@ -212,7 +249,6 @@ private:
   void getRandomMomentum();
   void updateMomentum();
   void updatePositionFromMomentum();
-  void calculatePseudoInverse();
   void computeJointProperties(int trajectoryPoint);
   bool isCurrentTrajectoryMeshToMeshCollisionFree() const;
 };
@@ -85,11 +85,23 @@ public:
   bool use_pseudo_inverse_;             /// enable pseudo inverse calculations or not.
   double pseudo_inverse_ridge_factor_;  /// set the ridge factor if pseudo inverse is enabled
 
+  bool use_distance_field_cache_;  /// keep the distance field between plans and only update the objects and octomap
+                                   /// regions that changed in the planning scene
+
   double joint_update_limit_;   /// set the update limit for the robot joints
   double min_clearance_;        /// the minimum distance that needs to be maintained to avoid obstacles
   double collision_threshold_;  /// the collision threshold cost that needs to be mainted to avoid collisions
   bool filter_mode_;
 
+  int convergence_window_;  /// number of iterations over which the relative cost improvement is measured; 0 (the
+                            /// default) disables cost-plateau detection. Convergence only ends the optimization once
+                            /// the path is collision free.
+  double convergence_relative_tolerance_;  /// the optimization is considered converged if the total cost improved by
+                                           /// less than this fraction over the last convergence_window_ iterations
+  double convergence_gradient_tolerance_;  /// the optimization is considered converged if the norm of the weighted
+                                           /// cost gradient drops below this value; 0 (the default) disables it, and
+                                           /// it is not used with stochastic descent
+
   static const std::vector<std::string> VALID_INITIALIZATION_METHODS;
   std::string trajectory_initialization_method_;  /// trajectory initialization method to be specified
 
@@ -36,10 +36,17 @@
 
 #pragma once
 
+#include <chomp_motion_planner/chomp_distance_field_cache.h>
+#include <chomp_motion_planner/chomp_optimizer.h>
 #include <chomp_motion_planner/chomp_parameters.h>
+#include <chomp_motion_planner/chomp_trajectory.h>
 #include <moveit/planning_interface/planning_request.h>
 #include <moveit/planning_interface/planning_response.h>
 #include <moveit/planning_scene/planning_scene.h>
+#include <moveit/robot_trajectory/robot_trajectory.h>
+
+#include <memory>
+#include <string>
 
 namespace chomp
 {
@@ -52,5 +59,32 @@ public:
   bool solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
              const planning_interface::MotionPlanRequest& req, const ChompParameters& params,
              planning_interface::MotionPlanDetailedResponse& res) const;
+
+private:
+  /**
+   * Fills in the initial trajectory towards goal_constraint
+   * @param use_input_trajectory seed the "fillTrajectory" method from the input trajectory in res, otherwise a
+   * minimum jerk trajectory is used
+   */
+  bool initializeTrajectory(ChompTrajectory& trajectory, const moveit::core::RobotState& start_state,
+                            const moveit_msgs::Constraints& goal_constraint, const std::string& group_name,
+                            const ChompParameters& params, bool use_input_trajectory,
+                            planning_interface::MotionPlanDetailedResponse& res) const;
+
+  /// \brief whether the last waypoint of trajectory satisfies the joint constraints of goal_constraint
+  bool isTrajectoryEndingInGoal(const robot_trajectory::RobotTrajectory& trajectory,
+                                const moveit_msgs::Constraints& goal_constraint) const;
+
+  /**
+   * Optimizes trajectory, retrying with the recovery parameters if enabled
+   * @return the last optimizer that ran, or nullptr if it could not be initialized
+   */
+  std::unique_ptr<ChompOptimizer> optimize(ChompTrajectory& trajectory,
+                                           const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                           const std::string& group_name, ChompParameters& params,
+                                           const moveit::core::RobotState& start_state,
+                                           const collision_detection::CollisionEnvHybrid* hy_env) const;
+
+  mutable ChompDistanceFieldCache distance_field_cache_;
 };
 }  // namespace chomp
@@ -0,0 +1,311 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <ros/ros.h>
+#include <chomp_motion_planner/chomp_distance_field_cache.h>
+#include <geometric_shapes/shapes.h>
+#include <octomap/octomap.h>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+
+namespace chomp
+{
+namespace
+{
+// octomap regions are cubes of 2^OCTOMAP_REGION_BITS voxels per side
+const int OCTOMAP_REGION_BITS = 4;
+
+std::uint64_t packRegion(unsigned int x, unsigned int y, unsigned int z)
+{
+  return (static_cast<std::uint64_t>(x) << 32) | (static_cast<std::uint64_t>(y) << 16) | z;
+}
+
+std::size_t hashPose(const Eigen::Isometry3d& pose)
+{
+  return boost::hash_range(pose.matrix().data(), pose.matrix().data() + 16);
+}
+
+std::size_t getObjectRevision(const collision_detection::World::Object& object)
+{
+  // shapes are immutable in the world, so a changed shape always comes with a new pointer
+  std::size_t revision = 0;
+  for (const shapes::ShapeConstPtr& shape : object.shapes_)
+    boost::hash_combine(revision, shape.get());
+  for (const Eigen::Isometry3d& pose : object.shape_poses_)
+    boost::hash_combine(revision, hashPose(pose));
+  return revision;
+}
+
+bool isOcTree(const collision_detection::World::Object& object)
+{
+  return object.shapes_.size() == 1 && object.shapes_[0]->type == shapes::OCTREE;
+}
+
+const octomap::OcTree& getOcTree(const collision_detection::World::Object& object)
+{
+  return *static_cast<const shapes::OcTree*>(object.shapes_[0].get())->octree;
+}
+
+/**
+ * Hashes the occupied leaves of each octomap region without expanding pruned leaves into voxels, so that checking an
+ * unchanged octomap only costs one pass over its leaves. The leaf hashes are summed up, so the order of the leaves
+ * doesn't matter.
+ */
+std::unordered_map<std::uint64_t, std::size_t> hashOctomapRegions(const collision_detection::World::Object& object)
+{
+  const octomap::OcTree& octree = getOcTree(object);
+  const unsigned int tree_depth = octree.getTreeDepth();
+
+  std::unordered_map<std::uint64_t, std::size_t> region_hashes;
+  for (octomap::OcTree::leaf_iterator it = octree.begin_leafs(), end = octree.end_leafs(); it != end; ++it)
+  {
+    if (!octree.isNodeOccupied(*it))
+      continue;
+
+    const octomap::OcTreeKey base = it.getIndexKey();
+    const unsigned int size = 1u << (tree_depth - it.getDepth());
+    std::size_t leaf_hash = it.getDepth();
+    boost::hash_combine(leaf_hash, boost::hash_range(&base[0], &base[0] + 3));
+
+    // leaves pruned above the region size cover several regions
+    for (unsigned int rx = base[0] >> OCTOMAP_REGION_BITS; rx <= (base[0] + size - 1) >> OCTOMAP_REGION_BITS; ++rx)
+      for (unsigned int ry = base[1] >> OCTOMAP_REGION_BITS; ry <= (base[1] + size - 1) >> OCTOMAP_REGION_BITS; ++ry)
+        for (unsigned int rz = base[2] >> OCTOMAP_REGION_BITS; rz <= (base[2] + size - 1) >> OCTOMAP_REGION_BITS; ++rz)
+          region_hashes[packRegion(rx, ry, rz)] += leaf_hash;
+  }
+
+  std::size_t tree_hash = hashPose(object.shape_poses_[0]);
+  boost::hash_combine(tree_hash, octree.getResolution());
+  for (std::pair<const std::uint64_t, std::size_t>& region : region_hashes)
+    boost::hash_combine(region.second, tree_hash);
+  return region_hashes;
+}
+}  // namespace
+
+std::shared_ptr<const collision_detection::CollisionEnvHybrid>
+ChompDistanceFieldCache::getCollisionEnv(const planning_scene::PlanningSceneConstPtr& planning_scene)
+{
+  const collision_detection::CollisionEnvConstPtr& active_env =
+      planning_scene->getCollisionEnv(planning_scene->getActiveCollisionDetectorName());
+  const collision_detection::CollisionEnvHybrid* scene_env =
+      dynamic_cast<const collision_detection::CollisionEnvHybrid*>(active_env.get());
+  if (!scene_env)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ros::WallTime wt = ros::WallTime::now();
+
+  const collision_detection::WorldConstPtr& scene_world = planning_scene->getWorld();
+  const collision_detection::World::ObjectConstPtr octomap =
+      scene_world->getObject(planning_scene::PlanningScene::OCTOMAP_NS);
+  const bool split_octomap = octomap && isOcTree(*octomap);
+  std::unordered_map<std::uint64_t, std::size_t> region_hashes;
+  if (split_octomap)
+    region_hashes = hashOctomapRegions(*octomap);
+
+  // other plans may still be reading the cached environment, so it is only updated in place if nobody else holds it.
+  // Otherwise a changed scene gets a new environment, and the old one is released by the last plan using it.
+  if (env_ && env_.use_count() > 1 && !isSynchronized(*scene_env, *scene_world, region_hashes))
+  {
+    ROS_DEBUG_NAMED("chomp_planner", "Cached distance field is in use by another plan, building a new one");
+    clear();
+  }
+
+  if (!env_ || robot_model_ != planning_scene->getRobotModel())
+  {
+    clear();
+    robot_model_ = planning_scene->getRobotModel();
+    world_ = std::make_shared<collision_detection::World>();
+    // same distance field parameters as the hybrid collision plugin, the world is filled in below
+    env_ = std::make_shared<collision_detection::CollisionEnvHybrid>(robot_model_, world_);
+  }
+  if (env_->getLinkPadding() != scene_env->getLinkPadding())
+    env_->setLinkPadding(scene_env->getLinkPadding());
+  if (env_->getLinkScale() != scene_env->getLinkScale())
+    env_->setLinkScale(scene_env->getLinkScale());
+
+  for (const std::string& id : scene_world->getObjectIds())
+  {
+    if (id == planning_scene::PlanningScene::OCTOMAP_NS && split_octomap)
+      syncOctomap(*octomap, region_hashes);
+    else
+      syncObject(*scene_world->getObject(id));
+  }
+
+  // drop the objects that were removed from the scene
+  for (auto it = object_revisions_.begin(); it != object_revisions_.end();)
+  {
+    if (scene_world->hasObject(it->first) && !(it->first == planning_scene::PlanningScene::OCTOMAP_NS && split_octomap))
+    {
+      ++it;
+      continue;
+    }
+    world_->removeObject(it->first);
+    it = object_revisions_.erase(it);
+  }
+  if (!split_octomap)
+  {
+    for (const auto& region : octomap_region_hashes_)
+      world_->removeObject(getOctomapRegionId(region.first));
+    octomap_region_hashes_.clear();
+  }
+
+  ROS_DEBUG_NAMED("chomp_planner", "Distance field cache synchronized in %f sec", (ros::WallTime::now() - wt).toSec());
+  return env_;
+}
+
+void ChompDistanceFieldCache::clear()
+{
+  env_.reset();
+  world_.reset();
+  robot_model_.reset();
+  object_revisions_.clear();
+  octomap_region_hashes_.clear();
+}
+
+bool ChompDistanceFieldCache::isSynchronized(
+    const collision_detection::CollisionEnvHybrid& scene_env, const collision_detection::World& scene_world,
+    const std::unordered_map<std::uint64_t, std::size_t>& region_hashes) const
+{
+  if (env_->getLinkPadding() != scene_env.getLinkPadding() || env_->getLinkScale() != scene_env.getLinkScale() ||
+      region_hashes != octomap_region_hashes_)
+    return false;
+
+  std::size_t num_objects = 0;
+  for (const std::string& id : scene_world.getObjectIds())
+  {
+    collision_detection::World::ObjectConstPtr object = scene_world.getObject(id);
+    if (id == planning_scene::PlanningScene::OCTOMAP_NS && isOcTree(*object))
+      continue;
+
+    std::map<std::string, std::size_t>::const_iterator it = object_revisions_.find(id);
+    if (it == object_revisions_.end() || it->second != getObjectRevision(*object))
+      return false;
+    ++num_objects;
+  }
+  return num_objects == object_revisions_.size();
+}
+
+void ChompDistanceFieldCache::syncObject(const collision_detection::World::Object& object)
+{
+  const std::size_t revision = getObjectRevision(object);
+  std::map<std::string, std::size_t>::iterator it = object_revisions_.find(object.id_);
+  if (it != object_revisions_.end() && it->second == revision)
+    return;
+
+  world_->removeObject(object.id_);
+  world_->addToObject(object.id_, object.shapes_, object.shape_poses_);
+  object_revisions_[object.id_] = revision;
+}
+
+void ChompDistanceFieldCache::syncOctomap(const collision_detection::World::Object& object,
+                                          std::unordered_map<std::uint64_t, std::size_t>& region_hashes)
+{
+  const octomap::OcTree& octree = getOcTree(object);
+  const Eigen::Isometry3d& pose = object.shape_poses_[0];
+  const unsigned int tree_depth = octree.getTreeDepth();
+
+  std::unordered_map<std::uint64_t, std::shared_ptr<octomap::OcTree>> changed_regions;
+  for (const std::pair<const std::uint64_t, std::size_t>& region : region_hashes)
+  {
+    auto cached = octomap_region_hashes_.find(region.first);
+    if (cached == octomap_region_hashes_.end() || cached->second != region.second)
+      changed_regions[region.first] = std::make_shared<octomap::OcTree>(octree.getResolution());
+  }
+
+  // only the voxels of the changed regions are expanded
+  if (!changed_regions.empty())
+  {
+    const unsigned int region_size = 1u << OCTOMAP_REGION_BITS;
+    for (octomap::OcTree::leaf_iterator it = octree.begin_leafs(), end = octree.end_leafs(); it != end; ++it)
+    {
+      if (!octree.isNodeOccupied(*it))
+        continue;
+
+      const octomap::OcTreeKey base = it.getIndexKey();
+      const unsigned int size = 1u << (tree_depth - it.getDepth());
+      for (unsigned int rx = base[0] >> OCTOMAP_REGION_BITS; rx <= (base[0] + size - 1) >> OCTOMAP_REGION_BITS; ++rx)
+        for (unsigned int ry = base[1] >> OCTOMAP_REGION_BITS; ry <= (base[1] + size - 1) >> OCTOMAP_REGION_BITS; ++ry)
+          for (unsigned int rz = base[2] >> OCTOMAP_REGION_BITS; rz <= (base[2] + size - 1) >> OCTOMAP_REGION_BITS;
+               ++rz)
+          {
+            auto changed = changed_regions.find(packRegion(rx, ry, rz));
+            if (changed == changed_regions.end())
+              continue;
+
+            // the part of the leaf inside this region
+            const unsigned int x0 = std::max<unsigned int>(base[0], rx * region_size);
+            const unsigned int x1 = std::min<unsigned int>(base[0] + size, (rx + 1) * region_size);
+            const unsigned int y0 = std::max<unsigned int>(base[1], ry * region_size);
+            const unsigned int y1 = std::min<unsigned int>(base[1] + size, (ry + 1) * region_size);
+            const unsigned int z0 = std::max<unsigned int>(base[2], rz * region_size);
+            const unsigned int z1 = std::min<unsigned int>(base[2] + size, (rz + 1) * region_size);
+            for (unsigned int x = x0; x < x1; ++x)
+              for (unsigned int y = y0; y < y1; ++y)
+                for (unsigned int z = z0; z < z1; ++z)
+                  changed->second->updateNode(octomap::OcTreeKey(x, y, z), true, true);
+          }
+    }
+  }
+
+  // replacing a region object only removes and adds the voxels of this region in the distance field
+  for (std::pair<const std::uint64_t, std::shared_ptr<octomap::OcTree>>& region : changed_regions)
+  {
+    region.second->updateInnerOccupancy();
+    const std::string id = getOctomapRegionId(region.first);
+    world_->removeObject(id);
+    world_->addToObject(id, std::make_shared<const shapes::OcTree>(region.second), pose);
+  }
+
+  int num_updated_regions = changed_regions.size();
+  for (const auto& region : octomap_region_hashes_)
+  {
+    if (region_hashes.find(region.first) == region_hashes.end())
+    {
+      world_->removeObject(getOctomapRegionId(region.first));
+      ++num_updated_regions;
+    }
+  }
+  octomap_region_hashes_.swap(region_hashes);
+
+  ROS_DEBUG_NAMED("chomp_planner", "Updated %d of %zu octomap regions in the distance field cache", num_updated_regions,
+                  octomap_region_hashes_.size());
+}
+
+std::string ChompDistanceFieldCache::getOctomapRegionId(std::uint64_t region) const
+{
+  return planning_scene::PlanningScene::OCTOMAP_NS + "/" + std::to_string(region >> 32) + "_" +
+         std::to_string((region >> 16) & 0xffff) + "_" + std::to_string(region & 0xffff);
+}
+}  // namespace chomp
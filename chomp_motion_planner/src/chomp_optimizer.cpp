@@ -43,6 +43,7 @@
 #include <moveit/planning_scene/planning_scene.h>
 #include <eigen3/Eigen/LU>
 #include <eigen3/Eigen/Core>
+#include <algorithm>
 #include <random>
 
 namespace chomp
@@ -56,7 +57,8 @@ double getRandomDouble()
 
 ChompOptimizer::ChompOptimizer(ChompTrajectory* trajectory, const planning_scene::PlanningSceneConstPtr& planning_scene,
                                const std::string& planning_group, const ChompParameters* parameters,
-                               const moveit::core::RobotState& start_state)
+                               const moveit::core::RobotState& start_state,
+                               const collision_detection::CollisionEnvHybrid* hy_env)
   : full_trajectory_(trajectory)
   , robot_model_(planning_scene->getRobotModel())
   , planning_group_(planning_group)
@@ -66,6 +68,7 @@ ChompOptimizer::ChompOptimizer(ChompTrajectory* trajectory, const planning_scene
   , state_(start_state)
   , start_state_(start_state)
   , initialized_(false)
+  , termination_reason_(NOT_STARTED)
 {
   std::vector<std::string> cd_names;
   planning_scene->getCollisionDetectorNames(cd_names);
@@ -78,8 +81,10 @@ ChompOptimizer::ChompOptimizer(ChompTrajectory* trajectory, const planning_scene
 
   ROS_INFO_STREAM("Active collision detector is: " + planning_scene->getActiveCollisionDetectorName());
 
-  hy_env_ = dynamic_cast<const collision_detection::CollisionEnvHybrid*>(
-      planning_scene->getCollisionEnv(planning_scene->getActiveCollisionDetectorName()).get());
+  // a cached environment whose world matches the planning scene may be passed in to reuse its distance field
+  hy_env_ = hy_env ? hy_env :
+                     dynamic_cast<const collision_detection::CollisionEnvHybrid*>(
+                         planning_scene->getCollisionEnv(planning_scene->getActiveCollisionDetectorName()).get());
   if (!hy_env_)
   {
     ROS_WARN_STREAM("Could not initialize hybrid collision world from planning scene");
@@ -144,9 +149,6 @@ void ChompOptimizer::initialize()
   collision_increments_ = Eigen::MatrixXd::Zero(num_vars_free_, num_joints_);
   final_increments_ = Eigen::MatrixXd::Zero(num_vars_free_, num_joints_);
   smoothness_derivative_ = Eigen::VectorXd::Zero(num_vars_all_);
-  jacobian_ = Eigen::MatrixXd::Zero(3, num_joints_);
-  jacobian_pseudo_inverse_ = Eigen::MatrixXd::Zero(num_joints_, 3);
-  jacobian_jacobian_tranpose_ = Eigen::MatrixXd::Zero(3, 3);
   random_state_ = Eigen::VectorXd::Zero(num_joints_);
   joint_state_velocities_ = Eigen::VectorXd::Zero(num_joints_);
 
@@ -258,6 +260,22 @@ void ChompOptimizer::initialize()
       }
     }
   }
+
+  // the set of joints moving a collision point is the same for every trajectory point
+  collision_point_parent_joints_.assign(num_collision_points_, std::vector<int>());
+  size_t max_parent_joints = 0;
+  for (int j = 0; j < num_collision_points_; ++j)
+  {
+    for (int k = 0; k < num_joints_; ++k)
+    {
+      if (isParent(collision_point_joint_names_[free_vars_start_][j], joint_names_[k]))
+        collision_point_parent_joints_[j].push_back(k);
+    }
+    max_parent_joints = std::max(max_parent_joints, collision_point_parent_joints_[j].size());
+  }
+  jacobian_ = Eigen::Matrix<double, 3, Eigen::Dynamic>::Zero(3, max_parent_joints);
+  joint_gradient_ = Eigen::VectorXd::Zero(max_parent_joints);
+
   initialized_ = true;
 }
 
@@ -311,11 +329,15 @@ bool ChompOptimizer::optimize()
   ros::WallTime start_time = ros::WallTime::now();
   // double averageCostVelocity = 0.0;
   // int currentCostIter = 0;
-  int cost_window = 10;
-  std::vector<double> costs(cost_window, 0.0);
   // double minimaThreshold = 0.05;
   bool should_break_out = false;
 
+  // ring buffer of the total cost of the last cost_window iterations, used for plateau detection
+  const int cost_window = std::max(parameters_->convergence_window_, 0);
+  std::vector<double> costs(cost_window, 0.0);
+
+  termination_reason_ = MAX_ITERATIONS;
+
   // iterate
   for (iteration_ = 0; iteration_ < parameters_->max_iterations_; iteration_++)
   {
@@ -364,6 +386,25 @@ bool ChompOptimizer::optimize()
     calculateCollisionIncrements();
     calculateTotalIncrements();
 
+    // convergence detection: relative cost improvement over the window and gradient norm. A cost increase isn't a
+    // plateau, and the gradient of stochastic descent only covers a single random row, so it isn't tested then.
+    TerminationReason convergence = NOT_STARTED;
+    if (cost_window > 0)
+    {
+      double& window_cost = costs[iteration_ % cost_window];
+      if (iteration_ >= cost_window)
+      {
+        double improvement = (window_cost - cost) / std::max(std::fabs(window_cost), 1e-12);
+        if (improvement >= 0.0 && improvement < parameters_->convergence_relative_tolerance_)
+          convergence = COST_PLATEAU;
+      }
+      window_cost = cost;
+    }
+    if (convergence == NOT_STARTED && parameters_->convergence_gradient_tolerance_ > 0.0 &&
+        !parameters_->use_stochastic_descent_ &&
+        getCostGradientNorm() < parameters_->convergence_gradient_tolerance_)
+      convergence = GRADIENT_CONVERGED;
+
     /// TODO: HMC BASED COMMENTED CODE BELOW, Need to uncomment and perform extensive testing by varying the HMC
     /// parameters values in the chomp_planning.yaml file so that CHOMP can find optimal paths
 
@@ -440,6 +481,18 @@ bool ChompOptimizer::optimize()
     if ((ros::WallTime::now() - start_time).toSec() > parameters_->planning_time_limit_)
     {
       ROS_WARN("Breaking out early due to time limit constraints.");
+      termination_reason_ = TIME_LIMIT;
+      break;
+    }
+
+    // convergence only cuts short the refinement of a path that was collision free before this iteration; a path that
+    // just became collision free still gets its max_iterations_after_collision_free_ iterations
+    if (convergence != NOT_STARTED && is_collision_free_ && collision_free_iteration_ > 0)
+    {
+      ROS_INFO("Chomp %s at iter %d (cost %f). Breaking out early.", getTerminationReasonString(convergence), iteration_,
+               cost);
+      termination_reason_ = convergence;
+      iteration_++;
       break;
     }
 
@@ -497,10 +550,12 @@ bool ChompOptimizer::optimize()
       collision_free_iteration_++;
       if (num_collision_free_iterations_ == 0)
       {
+        termination_reason_ = COLLISION_FREE;
         break;
       }
       else if (collision_free_iteration_ > num_collision_free_iterations_)
       {
+        termination_reason_ = COLLISION_FREE;
         // CollisionProximitySpace::TrajectorySafety safety = checkCurrentIterValidity();
         // if(safety != CollisionProximitySpace::MeshToMeshSafe &&
         //    safety != CollisionProximitySpace::InCollisionSafe) {
@@ -525,7 +580,8 @@ bool ChompOptimizer::optimize()
   group_trajectory_.getTrajectory() = best_group_trajectory_;
   updateFullTrajectory();
 
-  ROS_INFO("Terminated after %d iterations, using path from iteration %d", iteration_, last_improvement_iteration_);
+  ROS_INFO("Terminated after %d iterations (%s), using path from iteration %d", iteration_,
+           getTerminationReasonString(termination_reason_), last_improvement_iteration_);
   ROS_INFO("Optimization core finished in %f sec", (ros::WallTime::now() - start_time).toSec());
   ROS_INFO_STREAM("Time per iteration " << (ros::WallTime::now() - start_time).toSec() / (iteration_ * 1.0));
 
@@ -648,17 +704,7 @@ void ChompOptimizer::calculateCollisionIncrements()
       cartesian_gradient = vel_mag * (orthogonal_projector * potential_gradient - potential * curvature_vector);
 
       // pass it through the jacobian transpose to get the increments
-      getJacobian(i, collision_point_pos_eigen_[i][j], collision_point_joint_names_[i][j], jacobian_);
-
-      if (parameters_->use_pseudo_inverse_)
-      {
-        calculatePseudoInverse();
-        collision_increments_.row(i - free_vars_start_).transpose() -= jacobian_pseudo_inverse_ * cartesian_gradient;
-      }
-      else
-      {
-        collision_increments_.row(i - free_vars_start_).transpose() -= jacobian_.transpose() * cartesian_gradient;
-      }
+      addSparseCollisionIncrement(i, j, cartesian_gradient);
 
       /*
         if(point_is_in_collision_[i][j])
@@ -671,11 +717,38 @@ void ChompOptimizer::calculateCollisionIncrements()
   // cout << collision_increments_ << endl;
 }
 
-void ChompOptimizer::calculatePseudoInverse()
+void ChompOptimizer::addSparseCollisionIncrement(int trajectory_point, int collision_point,
+                                                 const Eigen::Vector3d& cartesian_gradient)
 {
-  jacobian_jacobian_tranpose_ =
-      jacobian_ * jacobian_.transpose() + Eigen::MatrixXd::Identity(3, 3) * parameters_->pseudo_inverse_ridge_factor_;
-  jacobian_pseudo_inverse_ = jacobian_.transpose() * jacobian_jacobian_tranpose_.inverse();
+  const std::vector<int>& parent_joints = collision_point_parent_joints_[collision_point];
+  const Eigen::Vector3d& position = collision_point_pos_eigen_[trajectory_point][collision_point];
+  const int num_parent_joints = parent_joints.size();
+  Eigen::MatrixXd::RowXpr increment = collision_increments_.row(trajectory_point - free_vars_start_);
+
+  // only the jacobian columns of the joints moving this point are non-zero, the others are skipped
+  auto jacobian = jacobian_.leftCols(num_parent_joints);
+  auto joint_gradient = joint_gradient_.head(num_parent_joints);
+  for (int k = 0; k < num_parent_joints; k++)
+  {
+    const int joint = parent_joints[k];
+    jacobian.col(k) =
+        joint_axes_[trajectory_point][joint].cross(position - joint_positions_[trajectory_point][joint]);
+  }
+
+  if (parameters_->use_pseudo_inverse_)
+  {
+    // the zero columns don't change J * J^T and give zero rows in the pseudo inverse
+    const Eigen::Matrix3d jacobian_jacobian_tranpose =
+        jacobian * jacobian.transpose() + Eigen::Matrix3d::Identity() * parameters_->pseudo_inverse_ridge_factor_;
+    joint_gradient.noalias() = jacobian.transpose() * (jacobian_jacobian_tranpose.inverse() * cartesian_gradient);
+  }
+  else
+  {
+    joint_gradient.noalias() = jacobian.transpose() * cartesian_gradient;
+  }
+
+  for (int k = 0; k < num_parent_joints; k++)
+    increment(parent_joints[k]) -= joint_gradient(k);
 }
 
 void ChompOptimizer::calculateTotalIncrements()
@@ -689,6 +762,33 @@ void ChompOptimizer::calculateTotalIncrements()
   }
 }
 
+double ChompOptimizer::getCostGradientNorm() const
+{
+  return (parameters_->smoothness_cost_weight_ * smoothness_increments_ +
+          parameters_->obstacle_cost_weight_ * collision_increments_)
+      .norm();
+}
+
+const char* ChompOptimizer::getTerminationReasonString(TerminationReason reason)
+{
+  switch (reason)
+  {
+    case NOT_STARTED:
+      return "not started";
+    case MAX_ITERATIONS:
+      return "maximum iterations reached";
+    case TIME_LIMIT:
+      return "time limit exceeded";
+    case COLLISION_FREE:
+      return "collision free path found";
+    case COST_PLATEAU:
+      return "cost plateaued";
+    case GRADIENT_CONVERGED:
+      return "gradient converged";
+  }
+  return "unknown";
+}
+
 void ChompOptimizer::addIncrementsToTrajectory()
 {
   const std::vector<const moveit::core::JointModel*>& joint_models = joint_model_group_->getActiveJointModels();
@@ -802,31 +902,6 @@ void ChompOptimizer::computeJointProperties(int trajectory_point)
   }
 }
 
-template <typename Derived>
-void ChompOptimizer::getJacobian(int trajectory_point, Eigen::Vector3d& collision_point_pos, std::string& joint_name,
-                                 Eigen::MatrixBase<Derived>& jacobian) const
-{
-  for (int j = 0; j < num_joints_; j++)
-  {
-    if (isParent(joint_name, joint_names_[j]))
-    {
-      Eigen::Vector3d column = joint_axes_[trajectory_point][j].cross(
-          Eigen::Vector3d(collision_point_pos(0), collision_point_pos(1), collision_point_pos(2)) -
-          joint_positions_[trajectory_point][j]);
-
-      jacobian.col(j)[0] = column.x();
-      jacobian.col(j)[1] = column.y();
-      jacobian.col(j)[2] = column.z();
-    }
-    else
-    {
-      jacobian.col(j)[0] = 0.0;
-      jacobian.col(j)[1] = 0.0;
-      jacobian.col(j)[2] = 0.0;
-    }
-  }
-}
-
 void ChompOptimizer::handleJointLimits()
 {
   const std::vector<const moveit::core::JointModel*> joint_models = joint_model_group_->getActiveJointModels();
@@ -53,12 +53,16 @@ ChompParameters::ChompParameters()
   ridge_factor_ = 0.0;
   use_pseudo_inverse_ = false;
   pseudo_inverse_ridge_factor_ = 1e-4;
+  use_distance_field_cache_ = false;
 
   joint_update_limit_ = 0.1;
   min_clearance_ = 0.2;
   collision_threshold_ = 0.07;
   use_stochastic_descent_ = true;
   filter_mode_ = false;
+  convergence_window_ = 0;
+  convergence_relative_tolerance_ = 1e-4;
+  convergence_gradient_tolerance_ = 0.0;
   trajectory_initialization_method_ = std::string("quintic-spline");
   enable_failure_recovery_ = false;
   max_recovery_attempts_ = 5;
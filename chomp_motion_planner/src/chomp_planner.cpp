@@ -40,14 +40,35 @@
 #include <chomp_motion_planner/chomp_optimizer.h>
 #include <moveit/robot_state/conversions.h>
 #include <moveit_msgs/MotionPlanRequest.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace chomp
 {
+namespace
+{
+// MoveIt's CHOMP planner plugin and adapter only load the parameters they know. The ones added by this package are
+// read from the same (move_group private) namespace, the given values are kept for those that aren't set.
+ChompParameters loadPlannerParams(const ChompParameters& params)
+{
+  ChompParameters planner_params(params);
+  ros::NodeHandle nh("~");
+  nh.getParamCached("use_distance_field_cache", planner_params.use_distance_field_cache_);
+  nh.getParamCached("convergence_window", planner_params.convergence_window_);
+  nh.getParamCached("convergence_relative_tolerance", planner_params.convergence_relative_tolerance_);
+  nh.getParamCached("convergence_gradient_tolerance", planner_params.convergence_gradient_tolerance_);
+  return planner_params;
+}
+}  // namespace
+
 bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_scene,
-                         const planning_interface::MotionPlanRequest& req, const ChompParameters& params,
+                         const planning_interface::MotionPlanRequest& req, const ChompParameters& input_params,
                          planning_interface::MotionPlanDetailedResponse& res) const
 {
   ros::WallTime start_time = ros::WallTime::now();
+  const ChompParameters params = loadPlannerParams(input_params);
   if (!planning_scene)
   {
     ROS_ERROR_STREAM_NAMED("chomp_planner", "No planning scene initialized.");
@@ -66,27 +87,186 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
     return false;
   }
 
-  ChompTrajectory trajectory(planning_scene->getRobotModel(), 3.0, .03, req.group_name);
-  robotStateToArray(start_state, req.group_name, trajectory.getTrajectoryPoint(0));
-
-  if (req.goal_constraints.size() != 1)
+  // each goal constraint is an alternative goal, e.g. one of several IK solutions for a grasp
+  if (req.goal_constraints.empty())
   {
-    ROS_ERROR_NAMED("chomp_planner", "Expecting exactly one goal constraint, got: %zd", req.goal_constraints.size());
+    ROS_ERROR_NAMED("chomp_planner", "Expecting at least one goal constraint");
     res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS;
     return false;
   }
 
-  if (req.goal_constraints[0].joint_constraints.empty() || !req.goal_constraints[0].position_constraints.empty() ||
-      !req.goal_constraints[0].orientation_constraints.empty())
+  for (const moveit_msgs::Constraints& goal_constraint : req.goal_constraints)
   {
-    ROS_ERROR_STREAM("Only joint-space goals are supported");
-    res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS;
+    if (goal_constraint.joint_constraints.empty() || !goal_constraint.position_constraints.empty() ||
+        !goal_constraint.orientation_constraints.empty())
+    {
+      ROS_ERROR_STREAM("Only joint-space goals are supported");
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_GOAL_CONSTRAINTS;
+      return false;
+    }
+  }
+
+  // an input trajectory only seeds the candidate whose goal it ends in, the others are interpolated
+  const size_t num_goals = req.goal_constraints.size();
+  int seeded_goal = -1;
+  if (params.trajectory_initialization_method_.compare("fillTrajectory") == 0)
+  {
+    if (res.trajectory_.empty())
+    {
+      ROS_ERROR_STREAM_NAMED("chomp_planner", "No input trajectory specified");
+      return false;
+    }
+    seeded_goal = 0;
+    for (size_t goal = 0; num_goals > 1 && goal < num_goals; ++goal)
+    {
+      if (isTrajectoryEndingInGoal(*res.trajectory_[0], req.goal_constraints[goal]))
+      {
+        seeded_goal = goal;
+        break;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<ChompTrajectory>> trajectories(num_goals);
+  for (size_t goal = 0; goal < num_goals; ++goal)
+  {
+    trajectories[goal] = std::make_unique<ChompTrajectory>(planning_scene->getRobotModel(), 3.0, .03, req.group_name);
+    if (!initializeTrajectory(*trajectories[goal], start_state, req.goal_constraints[goal], req.group_name, params,
+                              static_cast<int>(goal) == seeded_goal, res))
+      return false;
+  }
+
+  ROS_INFO_NAMED("chomp_planner", "CHOMP trajectory initialized using method: %s ",
+                 (params.trajectory_initialization_method_).c_str());
+
+  // optimize!
+  ros::WallTime create_time = ros::WallTime::now();
+
+  // the cached distance field stays unchanged while this plan holds it
+  std::shared_ptr<const collision_detection::CollisionEnvHybrid> hy_env;
+  if (params.use_distance_field_cache_)
+    hy_env = distance_field_cache_.getCollisionEnv(planning_scene);
+
+  // optimize the candidates for all goals concurrently on at most one thread per core, they only share the read-only
+  // planning scene. Each candidate gets its own copy of the parameters, which the recovery behaviour modifies
+  std::vector<ChompParameters> goal_params(num_goals, params);
+  std::vector<std::unique_ptr<ChompOptimizer>> optimizers(num_goals);
+  std::atomic<size_t> next_goal(0);
+  auto optimize_goals = [&]() {
+    for (size_t goal = next_goal++; goal < num_goals; goal = next_goal++)
+      optimizers[goal] =
+          optimize(*trajectories[goal], planning_scene, req.group_name, goal_params[goal], start_state, hy_env.get());
+  };
+
+  const size_t num_workers = std::min<size_t>(num_goals, std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers - 1);
+  for (size_t i = 1; i < num_workers; ++i)
+    workers.emplace_back(optimize_goals);
+  optimize_goals();
+  for (std::thread& worker : workers)
+    worker.join();
+
+  // pick the cheapest collision free candidate, or the cheapest one if none is collision free
+  int best_goal = -1;
+  for (size_t goal = 0; goal < num_goals; ++goal)
+  {
+    if (!optimizers[goal])
+      continue;
+    if (best_goal < 0)
+    {
+      best_goal = goal;
+      continue;
+    }
+    const ChompOptimizer& best = *optimizers[best_goal];
+    const ChompOptimizer& candidate = *optimizers[goal];
+    if (candidate.isCollisionFree() != best.isCollisionFree() ? candidate.isCollisionFree() :
+                                                                 candidate.getBestCost() < best.getBestCost())
+      best_goal = goal;
+  }
+
+  if (best_goal < 0)
+  {
+    ROS_ERROR_STREAM_NAMED("chomp_planner", "Could not initialize optimizer");
+    res.error_code_.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
     return false;
   }
+  if (num_goals > 1)
+    ROS_INFO_NAMED("chomp_planner", "Selected goal %d of %zu candidates", best_goal, num_goals);
+
+  ChompTrajectory& trajectory = *trajectories[best_goal];
+  const ChompOptimizer& optimizer = *optimizers[best_goal];
+
+  ROS_DEBUG_NAMED("chomp_planner", "Optimization actually took %f sec to run",
+                  (ros::WallTime::now() - create_time).toSec());
+  create_time = ros::WallTime::now();
+  // assume that the trajectory is now optimized, fill in the output structure:
+
+  ROS_DEBUG_NAMED("chomp_planner", "Output trajectory has %zd joints", trajectory.getNumJoints());
+
+  auto result = std::make_shared<robot_trajectory::RobotTrajectory>(planning_scene->getRobotModel(), req.group_name);
+  // fill in the entire trajectory
+  for (size_t i = 0; i < trajectory.getNumPoints(); i++)
+  {
+    const Eigen::MatrixXd::RowXpr source = trajectory.getTrajectoryPoint(i);
+    auto state = std::make_shared<moveit::core::RobotState>(start_state);
+    size_t joint_index = 0;
+    for (const moveit::core::JointModel* jm : result->getGroup()->getActiveJointModels())
+    {
+      assert(jm->getVariableCount() == 1);
+      state->setVariablePosition(jm->getFirstVariableIndex(), source[joint_index++]);
+    }
+    result->addSuffixWayPoint(state, 0.0);
+  }
+
+  res.trajectory_.resize(1);
+  res.trajectory_[0] = result;
+  res.description_.resize(1);
+  res.description_[0] = "plan";
+
+  ROS_DEBUG_NAMED("chomp_planner", "Bottom took %f sec to create", (ros::WallTime::now() - create_time).toSec());
+  ROS_DEBUG_NAMED("chomp_planner", "Serviced planning request in %f wall-seconds",
+                  (ros::WallTime::now() - start_time).toSec());
+
+  res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
+  res.processing_time_.resize(1);
+  res.processing_time_[0] = (ros::WallTime::now() - start_time).toSec();
+
+  // report planning failure if path has collisions
+  if (not optimizer.isCollisionFree())
+  {
+    ROS_ERROR_STREAM_NAMED("chomp_planner", "Motion plan is invalid.");
+    res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
+    return false;
+  }
+
+  // check that final state is within goal tolerances
+  kinematic_constraints::JointConstraint jc(planning_scene->getRobotModel());
+  const moveit::core::RobotState& last_state = result->getLastWayPoint();
+  for (const moveit_msgs::JointConstraint& constraint : req.goal_constraints[best_goal].joint_constraints)
+  {
+    if (!jc.configure(constraint) || !jc.decide(last_state).satisfied)
+    {
+      ROS_ERROR_STREAM_NAMED("chomp_planner", "Goal constraints are violated: " << constraint.joint_name);
+      res.error_code_.val = moveit_msgs::MoveItErrorCodes::GOAL_CONSTRAINTS_VIOLATED;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ChompPlanner::initializeTrajectory(ChompTrajectory& trajectory, const moveit::core::RobotState& start_state,
+                                        const moveit_msgs::Constraints& goal_constraint,
+                                        const std::string& group_name, const ChompParameters& params,
+                                        bool use_input_trajectory,
+                                        planning_interface::MotionPlanDetailedResponse& res) const
+{
+  robotStateToArray(start_state, group_name, trajectory.getTrajectoryPoint(0));
 
   const size_t goal_index = trajectory.getNumPoints() - 1;
   moveit::core::RobotState goal_state(start_state);
-  for (const moveit_msgs::JointConstraint& joint_constraint : req.goal_constraints[0].joint_constraints)
+  for (const moveit_msgs::JointConstraint& joint_constraint : goal_constraint.joint_constraints)
     goal_state.setVariablePosition(joint_constraint.joint_name, joint_constraint.position);
   if (!goal_state.satisfiesBounds())
   {
@@ -94,10 +274,9 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
     res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_ROBOT_STATE;
     return false;
   }
-  robotStateToArray(goal_state, req.group_name, trajectory.getTrajectoryPoint(goal_index));
+  robotStateToArray(goal_state, group_name, trajectory.getTrajectoryPoint(goal_index));
 
-  const moveit::core::JointModelGroup* model_group =
-      planning_scene->getRobotModel()->getJointModelGroup(req.group_name);
+  const moveit::core::JointModelGroup* model_group = start_state.getRobotModel()->getJointModelGroup(group_name);
   // fix the goal to move the shortest angular distance for wrap-around joints:
   for (size_t i = 0; i < model_group->getActiveJointModels().size(); i++)
   {
@@ -120,18 +299,15 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
   // fill in an initial trajectory based on user choice from the chomp_config.yaml file
   if (params.trajectory_initialization_method_.compare("quintic-spline") == 0)
     trajectory.fillInMinJerk();
+  else if (params.trajectory_initialization_method_.compare("fillTrajectory") == 0 && !use_input_trajectory)
+    trajectory.fillInMinJerk();
   else if (params.trajectory_initialization_method_.compare("linear") == 0)
     trajectory.fillInLinearInterpolation();
   else if (params.trajectory_initialization_method_.compare("cubic") == 0)
     trajectory.fillInCubicInterpolation();
   else if (params.trajectory_initialization_method_.compare("fillTrajectory") == 0)
   {
-    if (res.trajectory_.empty())
-    {
-      ROS_ERROR_STREAM_NAMED("chomp_planner", "No input trajectory specified");
-      return false;
-    }
-    else if (!(trajectory.fillInFromTrajectory(*res.trajectory_[0])))
+    if (!(trajectory.fillInFromTrajectory(*res.trajectory_[0])))
     {
       ROS_ERROR_STREAM_NAMED("chomp_planner", "Input trajectory has less than 2 points, "
                                               "trajectory must contain at least start and goal state");
@@ -144,28 +320,37 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
     return false;
   }
 
-  ROS_INFO_NAMED("chomp_planner", "CHOMP trajectory initialized using method: %s ",
-                 (params.trajectory_initialization_method_).c_str());
+  return true;
+}
 
-  // optimize!
-  ros::WallTime create_time = ros::WallTime::now();
+bool ChompPlanner::isTrajectoryEndingInGoal(const robot_trajectory::RobotTrajectory& trajectory,
+                                            const moveit_msgs::Constraints& goal_constraint) const
+{
+  if (trajectory.empty())
+    return false;
 
+  const moveit::core::RobotState& last_state = trajectory.getLastWayPoint();
+  for (const moveit_msgs::JointConstraint& joint_constraint : goal_constraint.joint_constraints)
+  {
+    const double position = last_state.getVariablePosition(joint_constraint.joint_name);
+    if (position < joint_constraint.position - joint_constraint.tolerance_below - 1e-6 ||
+        position > joint_constraint.position + joint_constraint.tolerance_above + 1e-6)
+      return false;
+  }
+  return true;
+}
+
+std::unique_ptr<ChompOptimizer> ChompPlanner::optimize(ChompTrajectory& trajectory,
+                                                       const planning_scene::PlanningSceneConstPtr& planning_scene,
+                                                       const std::string& group_name, ChompParameters& params,
+                                                       const moveit::core::RobotState& start_state,
+                                                       const collision_detection::CollisionEnvHybrid* hy_env) const
+{
   int replan_count = 0;
   bool replan_flag = false;
-  double org_learning_rate = 0.04, org_ridge_factor = 0.0, org_planning_time_limit = 10;
-  int org_max_iterations = 200;
-
-  // storing the initial chomp parameters values
-  org_learning_rate = params.learning_rate_;
-  org_ridge_factor = params.ridge_factor_;
-  org_planning_time_limit = params.planning_time_limit_;
-  org_max_iterations = params.max_iterations_;
 
   std::unique_ptr<ChompOptimizer> optimizer;
 
-  // create a non_const_params variable which stores the non constant version of the const params variable
-  ChompParameters params_nonconst = params;
-
   // while loop for replanning (recovery behaviour) if collision free optimized solution not found
   while (true)
   {
@@ -173,37 +358,36 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
     {
       // increase learning rate in hope to find a successful path; increase ridge factor to avoid obstacles; add 5
       // additional secs in hope to find a solution; increase maximum iterations
-      params_nonconst.setRecoveryParams(params_nonconst.learning_rate_ + 0.02, params_nonconst.ridge_factor_ + 0.002,
-                                        params_nonconst.planning_time_limit_ + 5, params_nonconst.max_iterations_ + 50);
+      params.setRecoveryParams(params.learning_rate_ + 0.02, params.ridge_factor_ + 0.002,
+                               params.planning_time_limit_ + 5, params.max_iterations_ + 50);
     }
 
     // initialize a ChompOptimizer object to load up the optimizer with default parameters or with updated parameters in
     // case of a recovery behaviour
     optimizer =
-        std::make_unique<ChompOptimizer>(&trajectory, planning_scene, req.group_name, &params_nonconst, start_state);
+        std::make_unique<ChompOptimizer>(&trajectory, planning_scene, group_name, &params, start_state, hy_env);
     if (!optimizer->isInitialized())
     {
       ROS_ERROR_STREAM_NAMED("chomp_planner", "Could not initialize optimizer");
-      res.error_code_.val = moveit_msgs::MoveItErrorCodes::PLANNING_FAILED;
-      return false;
+      return nullptr;
     }
 
-    ROS_DEBUG_NAMED("chomp_planner", "Optimization took %f sec to create", (ros::WallTime::now() - create_time).toSec());
-
     bool optimization_result = optimizer->optimize();
+    ROS_INFO_NAMED("chomp_planner", "Optimizer stopped: %s",
+                   ChompOptimizer::getTerminationReasonString(optimizer->getTerminationReason()));
 
     // replan with updated parameters if no solution is found
-    if (params_nonconst.enable_failure_recovery_)
+    if (params.enable_failure_recovery_)
     {
       ROS_INFO_NAMED("chomp_planner",
                      "Planned with Chomp Parameters (learning_rate, ridge_factor, "
                      "planning_time_limit, max_iterations), attempt: # %d ",
                      (replan_count + 1));
       ROS_INFO_NAMED("chomp_planner", "Learning rate: %f ridge factor: %f planning time limit: %f max_iterations %d ",
-                     params_nonconst.learning_rate_, params_nonconst.ridge_factor_,
-                     params_nonconst.planning_time_limit_, params_nonconst.max_iterations_);
+                     params.learning_rate_, params.ridge_factor_,
+                     params.planning_time_limit_, params.max_iterations_);
 
-      if (!optimization_result && replan_count < params_nonconst.max_recovery_attempts_)
+      if (!optimization_result && replan_count < params.max_recovery_attempts_)
       {
         replan_count++;
         replan_flag = true;
@@ -217,65 +401,6 @@ bool ChompPlanner::solve(const planning_scene::PlanningSceneConstPtr& planning_s
       break;
   }  // end of while loop
 
-  // resetting the CHOMP Parameters to the original values after a successful plan
-  params_nonconst.setRecoveryParams(org_learning_rate, org_ridge_factor, org_planning_time_limit, org_max_iterations);
-
-  ROS_DEBUG_NAMED("chomp_planner", "Optimization actually took %f sec to run",
-                  (ros::WallTime::now() - create_time).toSec());
-  create_time = ros::WallTime::now();
-  // assume that the trajectory is now optimized, fill in the output structure:
-
-  ROS_DEBUG_NAMED("chomp_planner", "Output trajectory has %zd joints", trajectory.getNumJoints());
-
-  auto result = std::make_shared<robot_trajectory::RobotTrajectory>(planning_scene->getRobotModel(), req.group_name);
-  // fill in the entire trajectory
-  for (size_t i = 0; i < trajectory.getNumPoints(); i++)
-  {
-    const Eigen::MatrixXd::RowXpr source = trajectory.getTrajectoryPoint(i);
-    auto state = std::make_shared<moveit::core::RobotState>(start_state);
-    size_t joint_index = 0;
-    for (const moveit::core::JointModel* jm : result->getGroup()->getActiveJointModels())
-    {
-      assert(jm->getVariableCount() == 1);
-      state->setVariablePosition(jm->getFirstVariableIndex(), source[joint_index++]);
-    }
-    result->addSuffixWayPoint(state, 0.0);
-  }
-
-  res.trajectory_.resize(1);
-  res.trajectory_[0] = result;
-  res.description_.resize(1);
-  res.description_[0] = "plan";
-
-  ROS_DEBUG_NAMED("chomp_planner", "Bottom took %f sec to create", (ros::WallTime::now() - create_time).toSec());
-  ROS_DEBUG_NAMED("chomp_planner", "Serviced planning request in %f wall-seconds",
-                  (ros::WallTime::now() - start_time).toSec());
-
-  res.error_code_.val = moveit_msgs::MoveItErrorCodes::SUCCESS;
-  res.processing_time_.resize(1);
-  res.processing_time_[0] = (ros::WallTime::now() - start_time).toSec();
-
-  // report planning failure if path has collisions
-  if (not optimizer->isCollisionFree())
-  {
-    ROS_ERROR_STREAM_NAMED("chomp_planner", "Motion plan is invalid.");
-    res.error_code_.val = moveit_msgs::MoveItErrorCodes::INVALID_MOTION_PLAN;
-    return false;
-  }
-
-  // check that final state is within goal tolerances
-  kinematic_constraints::JointConstraint jc(planning_scene->getRobotModel());
-  const moveit::core::RobotState& last_state = result->getLastWayPoint();
-  for (const moveit_msgs::JointConstraint& constraint : req.goal_constraints[0].joint_constraints)
-  {
-    if (!jc.configure(constraint) || !jc.decide(last_state).satisfied)
-    {
-      ROS_ERROR_STREAM_NAMED("chomp_planner", "Goal constraints are violated: " << constraint.joint_name);
-      res.error_code_.val = moveit_msgs::MoveItErrorCodes::GOAL_CONSTRAINTS_VIOLATED;
-      return false;
-    }
-  }
-
-  return true;
+  return optimizer;
 }
 }  // namespace chomp
@@ -215,6 +215,8 @@ BOOL Ros_Controller_Init(Controller* controller)
 	{
 		controller->sdMotionConnections[i] = INVALID_SOCKET;
 		controller->tidMotionConnections[i] = INVALID_TASK;
+		controller->nextSequence[i] = 0;
+		controller->bCheckSequence[i] = FALSE;
 	}
 	controller->tidIncMoveThread = INVALID_TASK;
 
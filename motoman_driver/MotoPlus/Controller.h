@@ -55,7 +55,7 @@
 #define IO_FEEDBACK_RESERVED_8				11137  //output# 904 
 
 #define MAX_IO_CONNECTIONS	1
-#define MAX_MOTION_CONNECTIONS	1
+#define MAX_MOTION_CONNECTIONS	2	// a streaming connection, and one for motion control commands
 #define MAX_STATE_CONNECTIONS	4
 
 #if (DX100)
@@ -139,6 +139,8 @@ typedef struct
 	// Motion Server Connection
 	int	sdMotionConnections[MAX_MOTION_CONNECTIONS];		// Socket Descriptor array for Motion Server
 	int	tidMotionConnections[MAX_MOTION_CONNECTIONS];  		// ThreadId array for Motion Server
+	int nextSequence[MAX_MOTION_CONNECTIONS];				// sequence number expected for the next trajectory point of each connection
+	BOOL bCheckSequence[MAX_MOTION_CONNECTIONS];			// reject trajectory points that are not nextSequence (ROS_CMD_START_SEQUENCE_CHECK)
 	int tidIncMoveThread;  									// ThreadId for sending the incremental move to the controller
 
 #ifdef DX100
@@ -132,6 +132,9 @@ CtrlGroup* Ros_CtrlGroup_Create(int groupNo, BOOL bIsLastGrpToInit, float interp
 		memset(&ctrlGroup->inc_q, 0x00, sizeof(Incremental_q));
 		ctrlGroup->inc_q.q_lock = mpSemBCreate(SEM_Q_FIFO, SEM_FULL);
 
+		memset(&ctrlGroup->trajPt_q, 0x00, sizeof(JointMotionData_q));
+		ctrlGroup->trajPt_q.q_lock = mpSemBCreate(SEM_Q_FIFO, SEM_FULL);
+
 #ifdef DX100		
 		speedCap = GP_getGovForIncMotion(groupNo);
 		if(speedCap != -1)
@@ -34,6 +34,7 @@
 
 
 #define Q_SIZE 200
+#define TRAJ_PT_Q_SIZE 8	// must hold all the points of a ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI message (ROS_MAX_TRAJ_PTS_PER_MSG)
 
 #if (DX100 || DX200 || FS100)
 #define Q_LOCK_TIMEOUT 1000
@@ -73,6 +74,14 @@ typedef struct
 	float acc[MP_GRP_AXES_NUM];		// acceleration in radians/s^2
 } JointMotionData;
 
+typedef struct
+{
+	SEM_ID q_lock;
+	LONG cnt;
+	LONG idx;
+	JointMotionData data[TRAJ_PT_Q_SIZE];
+} JointMotionData_q;
+
 //---------------------------------------------------------------
 // CtrlGroup:
 // Structure containing all the data related to a control group 
@@ -93,8 +102,9 @@ typedef struct
 	long q_time;								// time to which the queue has been processed
 	
 	JointMotionData jointMotionData;			// joint motion command data in radian
+	JointMotionData_q trajPt_q;					// trajectory points waiting to be interpolated
 	JointMotionData jointMotionDataToProcess;	// joint motion command data in radian to process
-	BOOL hasDataToProcess;						// indicates that there is data to process
+	BOOL hasDataToProcess;						// indicates that there is data to process (in trajPt_q or being interpolated)
 	int tidAddToIncQueue;						// ThreadId to add incremental values to the queue
 	int timeLeftover_ms;						// Time left over after reaching the end of a trajectory to complete the interpolation period
 	long prevPulsePos[MAX_PULSE_AXES];			// The commanded pulse position that the trajectory starts at (Ros_MotionServer_StartTrajMode)
@@ -32,6 +32,10 @@
 #include "MotoROS.h"
 #include "debug.h"
 
+#if (TRAJ_PT_Q_SIZE < ROS_MAX_TRAJ_PTS_PER_MSG)
+#error "TRAJ_PT_Q_SIZE must be at least ROS_MAX_TRAJ_PTS_PER_MSG"
+#endif
+
 //-----------------------
 // Function Declarations
 //-----------------------
@@ -41,19 +45,24 @@ void Ros_MotionServer_StopConnection(Controller* controller, int connectionIndex
 
 // WaitForSimpleMsg Task:
 void Ros_MotionServer_WaitForSimpleMsg(Controller* controller, int connectionIndex);
-BOOL Ros_MotionServer_SimpleMsgProcess(Controller* controller, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
-int Ros_MotionServer_MotionCtrlProcess(Controller* controller, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
+BOOL Ros_MotionServer_SimpleMsgProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
+int Ros_MotionServer_MotionCtrlProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
 BOOL Ros_MotionServer_StopMotion(Controller* controller);
 BOOL Ros_MotionServer_ServoPower(Controller* controller, int servoOnOff);
 BOOL Ros_MotionServer_ResetAlarm(Controller* controller);
 BOOL Ros_MotionServer_StartTrajMode(Controller* controller);
 BOOL Ros_MotionServer_StopTrajMode(Controller* controller);
-int Ros_MotionServer_JointTrajDataProcess(Controller* controller, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
+int Ros_MotionServer_JointTrajDataProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
 int Ros_MotionServer_InitTrajPointFull(CtrlGroup* ctrlGroup, SmBodyJointTrajPtFull* jointTrajData);
 int Ros_MotionServer_InitTrajPointFullEx(CtrlGroup* ctrlGroup, SmBodyJointTrajPtExData* jointTrajDataEx, int sequence);
 int Ros_MotionServer_AddTrajPointFull(CtrlGroup* ctrlGroup, SmBodyJointTrajPtFull* jointTrajData);
 int Ros_MotionServer_AddTrajPointFullEx(CtrlGroup* ctrlGroup, SmBodyJointTrajPtExData* jointTrajDataEx, int sequence);
-int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
+int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
+int Ros_MotionServer_JointTrajPtFullExToGroups(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, SmBodyJointTrajPtFullEx* msgBody, SimpleMsg* replyMsg);
+int Ros_MotionServer_JointTrajPtFullMultiProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
+BOOL Ros_MotionServer_IsExpectedSequence(Controller* controller, int connectionIndex, int sequence);
+int Ros_MotionServer_GetJointTrajPtFullExSize(SmBodyJointTrajPtFullEx* point);
+int Ros_MotionServer_GetExpectedByteSizeForJointTrajPtFullMulti(SimpleMsg* receiveMsg, int recvByteSize);
 int Ros_MotionServer_GetDhParameters(Controller* controller, SimpleMsg* replyMsg);
 int Ros_MotionServer_SetSelectedTool(Controller* controller, SimpleMsg* receiveMsg, SimpleMsg* replyMsg);
 void Ros_MotionServer_EnsureEcoModeIsDisabled(Controller* controller);
@@ -62,6 +71,9 @@ void Ros_MotionServer_EnsureEcoModeIsDisabled(Controller* controller);
 void Ros_MotionServer_AddToIncQueueProcess(Controller* controller, int groupNo);
 void Ros_MotionServer_JointTrajDataToIncQueue(Controller* controller, int groupNo);
 BOOL Ros_MotionServer_AddPulseIncPointToQ(Controller* controller, int groupNo, Incremental_data* dataToEnQ);
+BOOL Ros_MotionServer_AddTrajPointToQ(CtrlGroup* ctrlGroup, JointMotionData* dataToEnQ);
+BOOL Ros_MotionServer_GetTrajPointFromQ(CtrlGroup* ctrlGroup);
+BOOL Ros_MotionServer_ClearTrajPointQ(CtrlGroup* ctrlGroup);
 BOOL Ros_MotionServer_ClearQ_All(Controller* controller);
 BOOL Ros_MotionServer_HasDataInQueue(Controller* controller);
 int Ros_MotionServer_GetQueueCnt(Controller* controller, int groupNo);
@@ -110,8 +122,9 @@ ATTEMPT_MOTION_CONNECTION:
 		}
 		else
 		{
-			puts("Motion server already connected... closing old connection.");
-			Ros_MotionServer_StopConnection(controller, 0); //close socket, cleanup resources, and delete tasks
+			puts("Motion server already connected... closing old connections.");
+			for (connectionIndex = 0; connectionIndex < MAX_MOTION_CONNECTIONS; connectionIndex++)
+				Ros_MotionServer_StopConnection(controller, connectionIndex); //close socket, cleanup resources, and delete tasks
 			goto ATTEMPT_MOTION_CONNECTION; //goto is sometimes useful... don't judge me
 		}
 	}
@@ -206,12 +219,13 @@ void Ros_MotionServer_StopConnection(Controller* controller, int connectionIndex
 	mpClose(controller->sdMotionConnections[connectionIndex]);
 	//mark connection as invalid
 	controller->sdMotionConnections[connectionIndex] = INVALID_SOCKET;
+	controller->bCheckSequence[connectionIndex] = FALSE;
 
 	// Check if there are still some valid connection
 	bDeleteIncMovTask = TRUE;
 	for(i=0; i<MAX_MOTION_CONNECTIONS; i++)
 	{
-		if(controller->sdMotionConnections[connectionIndex] != INVALID_SOCKET)
+		if(controller->sdMotionConnections[i] != INVALID_SOCKET)
 		{
 			bDeleteIncMovTask = FALSE;
 			break;
@@ -227,7 +241,7 @@ void Ros_MotionServer_StopConnection(Controller* controller, int connectionIndex
 		// Stop adding increment to queue (for each ctrlGroup
 		for(i=0; i < controller->numGroup; i++)
 		{
-			controller->ctrlGroups[i]->hasDataToProcess = FALSE;
+			Ros_MotionServer_ClearTrajPointQ(controller->ctrlGroups[i]);
 			tid = controller->ctrlGroups[i]->tidAddToIncQueue;
 			controller->ctrlGroups[i]->tidAddToIncQueue = INVALID_TASK;
 			mpDeleteTask(tid);
@@ -282,6 +296,9 @@ int Ros_MotionServer_GetExpectedByteSizeForMessageType(SimpleMsg* receiveMsg, in
 		else
 			expectedSize = minSize + sizeof(SmBodyJointTrajPtFullEx);
 		break;
+	case ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI:
+		expectedSize = Ros_MotionServer_GetExpectedByteSizeForJointTrajPtFullMulti(receiveMsg, recvByteSize);
+		break;
 	case ROS_MSG_MOTO_JOINT_FEEDBACK_EX:
 		expectedSize = minSize + sizeof(SmBodyJointFeedbackEx);
 		break;
@@ -309,6 +326,51 @@ int Ros_MotionServer_GetExpectedByteSizeForMessageType(SimpleMsg* receiveMsg, in
 	return expectedSize;
 }
 
+//-----------------------------------------------------------------------
+// Size of a ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX point that only holds its valid groups
+//-----------------------------------------------------------------------
+int Ros_MotionServer_GetJointTrajPtFullExSize(SmBodyJointTrajPtFullEx* point)
+{
+	return (sizeof(int) * 2) + (sizeof(SmBodyJointTrajPtExData) * point->numberOfValidGroups);
+}
+
+//-----------------------------------------------------------------------
+// The points of a ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI message only hold their valid groups,
+// so the size is known once the [numberOfValidGroups] field of every point is received
+//-----------------------------------------------------------------------
+int Ros_MotionServer_GetExpectedByteSizeForJointTrajPtFullMulti(SimpleMsg* receiveMsg, int recvByteSize)
+{
+	int minSize = sizeof(SmPrefix) + sizeof(SmHeader);
+	int maxSize = minSize + sizeof(SmBodyJointTrajPtFullMulti);
+	int invalidSize = sizeof(SimpleMsg) + 1; //can never be received, so the message is rejected as invalid size
+	SmBodyJointTrajPtFullEx* point;
+	int expectedSize, i;
+
+	expectedSize = minSize + sizeof(int);
+	if (recvByteSize < expectedSize) //make sure I can at least get to [numberOfPoints] field
+		return maxSize;
+
+	if (receiveMsg->body.jointTrajDataMulti.numberOfPoints < 1 ||
+		receiveMsg->body.jointTrajDataMulti.numberOfPoints > ROS_MAX_TRAJ_PTS_PER_MSG)
+		return invalidSize;
+
+	for (i = 0; i < receiveMsg->body.jointTrajDataMulti.numberOfPoints; i += 1)
+	{
+		if (recvByteSize < expectedSize + (int)sizeof(int)) //make sure I can get to [numberOfValidGroups] field of this point
+			return maxSize;
+
+		point = (SmBodyJointTrajPtFullEx*)((char*)receiveMsg + expectedSize);
+		if (point->numberOfValidGroups < 1 || point->numberOfValidGroups > MOT_MAX_GR)
+			return invalidSize;
+
+		expectedSize += Ros_MotionServer_GetJointTrajPtFullExSize(point);
+		if (expectedSize > maxSize)
+			return invalidSize;
+	}
+
+	return expectedSize;
+}
+
 //-----------------------------------------------------------------------
 // Task that waits to receive new SimpleMessage and then processes it
 //-----------------------------------------------------------------------
@@ -330,8 +392,8 @@ void Ros_MotionServer_WaitForSimpleMsg(Controller* controller, int connectionInd
 		if (!bSkipNetworkRecv) //if I don't already have an extra complete packet buffered from the previous recv
 		{
 			//Receive message from the PC
-			memset((&receiveMsg) + partialMsgByteCount, 0x00, sizeof(SimpleMsg) - partialMsgByteCount);
-			byteSize = mpRecv(controller->sdMotionConnections[connectionIndex], (char*)((&receiveMsg) + partialMsgByteCount), sizeof(SimpleMsg) - partialMsgByteCount, 0);
+			memset((char*)(&receiveMsg) + partialMsgByteCount, 0x00, sizeof(SimpleMsg) - partialMsgByteCount);
+			byteSize = mpRecv(controller->sdMotionConnections[connectionIndex], (char*)(&receiveMsg) + partialMsgByteCount, sizeof(SimpleMsg) - partialMsgByteCount, 0);
 			if (byteSize <= 0)
 				break; //end connection
 
@@ -359,7 +421,7 @@ void Ros_MotionServer_WaitForSimpleMsg(Controller* controller, int connectionInd
 			else if (byteSize >= expectedSize) // Check message size
 			{
 				// Process the simple message
-				ret = Ros_MotionServer_SimpleMsgProcess(controller, &receiveMsg, &replyMsg);
+				ret = Ros_MotionServer_SimpleMsgProcess(controller, connectionIndex, &receiveMsg, &replyMsg);
 				if (ret != OK) //error during processing
 				{
 					break; //disconnect
@@ -423,7 +485,7 @@ void Ros_MotionServer_WaitForSimpleMsg(Controller* controller, int connectionInd
 // Checks the type of message and processes it accordingly
 // Return -1=Failure; 0=Success; 1=CloseConnection; 
 //-----------------------------------------------------------------------
-int Ros_MotionServer_SimpleMsgProcess(Controller* controller, SimpleMsg* receiveMsg, SimpleMsg* replyMsg)
+int Ros_MotionServer_SimpleMsgProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, SimpleMsg* replyMsg)
 {
 	int ret = ERROR;
 	int invalidSubcode = 0;
@@ -441,17 +503,22 @@ int Ros_MotionServer_SimpleMsgProcess(Controller* controller, SimpleMsg* receive
 		break;
 
 	case ROS_MSG_JOINT_TRAJ_PT_FULL:
-		ret = Ros_MotionServer_JointTrajDataProcess(controller, receiveMsg, replyMsg);
+		ret = Ros_MotionServer_JointTrajDataProcess(controller, connectionIndex, receiveMsg, replyMsg);
 		break;
 
 	//-----------------------
 	case ROS_MSG_MOTO_MOTION_CTRL:
-		ret = Ros_MotionServer_MotionCtrlProcess(controller, receiveMsg, replyMsg);
+		ret = Ros_MotionServer_MotionCtrlProcess(controller, connectionIndex, receiveMsg, replyMsg);
 		break;
 
 	//-----------------------
 	case ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX:
-		ret = Ros_MotionServer_JointTrajPtFullExProcess(controller, receiveMsg, replyMsg);
+		ret = Ros_MotionServer_JointTrajPtFullExProcess(controller, connectionIndex, receiveMsg, replyMsg);
+		break;
+
+	//-----------------------
+	case ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI:
+		ret = Ros_MotionServer_JointTrajPtFullMultiProcess(controller, connectionIndex, receiveMsg, replyMsg);
 		break;
 
 
@@ -508,16 +575,26 @@ int Ros_MotionServer_SimpleMsgProcess(Controller* controller, SimpleMsg* receive
 // Processes message of type: ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX
 // Return -1=Failure; 0=Success; 1=CloseConnection; 
 //-----------------------------------------------------------------------
-int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, SimpleMsg* receiveMsg, 
+int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, 
 											  SimpleMsg* replyMsg)
 {
-	SmBodyJointTrajPtFullEx* msgBody;	
+	Ros_MotionServer_JointTrajPtFullExToGroups(controller, connectionIndex, receiveMsg, &receiveMsg->body.jointTrajDataEx, replyMsg);
+	return 0;
+}
+
+
+//-----------------------------------------------------------------------
+// Adds a ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX point to the trajectory of each of its groups
+// and sets the reply for it.
+// Return the result code of the reply (ROS_RESULT_*)
+//-----------------------------------------------------------------------
+int Ros_MotionServer_JointTrajPtFullExToGroups(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, 
+											   SmBodyJointTrajPtFullEx* msgBody, SimpleMsg* replyMsg)
+{
 	CtrlGroup* ctrlGroup;
 	int ret, i;
 	FlagsValidFields validationFlags;
 
-	msgBody = &receiveMsg->body.jointTrajDataEx;
-
 	// Check if controller is able to receive incremental move and if the incremental move thread is running
 	if(!Ros_Controller_IsMotionReady(controller))
 	{
@@ -527,26 +604,27 @@ int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, SimpleMsg*
 		{
 			Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_NOT_READY, subcode, replyMsg, msgBody->jointTrajPtData[i].groupNo);
 		}
-		return 0;
+		return ROS_RESULT_NOT_READY;
 	}
 
-	// Pre-check to ensure no groups are busy
+	// Pre-check to ensure no groups are busy: the point must fit in the queue of every group, and a new
+	// trajectory only starts once the points of the previous one are processed
 	for (i = 0; i < msgBody->numberOfValidGroups; i += 1)
 	{
 		if (Ros_Controller_IsValidGroupNo(controller, msgBody->jointTrajPtData[i].groupNo))
 		{
 			ctrlGroup = controller->ctrlGroups[msgBody->jointTrajPtData[i].groupNo];
-			if (ctrlGroup->hasDataToProcess)
+			if ((msgBody->sequence == 0 && ctrlGroup->hasDataToProcess) || ctrlGroup->trajPt_q.cnt >= TRAJ_PT_Q_SIZE)
 			{
 				Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_BUSY, 0, replyMsg, msgBody->jointTrajPtData[i].groupNo);
-				return 0;
+				return ROS_RESULT_BUSY;
 			}
 		}
 		else
 		{
 			printf("ERROR: GroupNo %d is not valid\n", msgBody->jointTrajPtData[i].groupNo);
 			Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ROS_RESULT_INVALID_GROUPNO, replyMsg, msgBody->jointTrajPtData[i].groupNo);
-			return 0;
+			return ROS_RESULT_INVALID;
 		}
 			
 		// Check that minimum information (time, position, velocity) is valid
@@ -555,10 +633,17 @@ int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, SimpleMsg*
 		{
 			printf("ERROR: Validfields = %d\r\n", msgBody->jointTrajPtData[i].validFields);
 			Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ROS_RESULT_INVALID_DATA_INSUFFICIENT, replyMsg, msgBody->jointTrajPtData[i].groupNo);
-			return 0;
+			return ROS_RESULT_INVALID;
 		}
 	}
 
+	// The sequence is checked for the whole point, so that groups that skip points don't need to follow it
+	if(!Ros_MotionServer_IsExpectedSequence(controller, connectionIndex, msgBody->sequence))
+	{
+		Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ROS_RESULT_INVALID_SEQUENCE, replyMsg, msgBody->jointTrajPtData[0].groupNo);
+		return ROS_RESULT_INVALID;
+	}
+
 	for (i = 0; i < msgBody->numberOfValidGroups; i += 1)
 	{
 		ctrlGroup = controller->ctrlGroups[msgBody->jointTrajPtData[i].groupNo];
@@ -579,7 +664,7 @@ int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, SimpleMsg*
 			{
 				printf("ERROR: Ros_MotionServer_InitTrajPointFullEx returned %d\n", ret);
 				Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ret, replyMsg, msgBody->jointTrajPtData[i].groupNo);
-				return 0; //stop processing other groups in this loop
+				return ROS_RESULT_INVALID; //stop processing other groups in this loop
 			}
 		}
 		else if(msgBody->sequence > 0)// Subsequent trajectory points
@@ -594,22 +679,78 @@ int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, SimpleMsg*
 			{
 				printf("ERROR: Ros_MotionServer_AddTrajPointFullEx returned %d\n", ret);
 				Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_BUSY, 0, replyMsg, msgBody->jointTrajPtData[i].groupNo);
-				return 0; //stop processing other groups in this loop
+				return ROS_RESULT_BUSY; //stop processing other groups in this loop
 			}
 			else
 			{
 				printf("ERROR: Ros_MotionServer_AddTrajPointFullEx returned %d\n", ret);
 				Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ret, replyMsg, msgBody->jointTrajPtData[i].groupNo);
-				return 0; //stop processing other groups in this loop
+				return ROS_RESULT_INVALID; //stop processing other groups in this loop
 			}
 		}
 		else
 		{
 			Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ROS_RESULT_INVALID_SEQUENCE, replyMsg, msgBody->jointTrajPtData[i].groupNo);
-			return 0; //stop processing other groups in this loop
+			return ROS_RESULT_INVALID; //stop processing other groups in this loop
 		}
 	}
 
+	controller->nextSequence[connectionIndex] = msgBody->sequence + 1;
+	return ROS_RESULT_SUCCESS;
+}
+
+
+//-----------------------------------------------------------------------
+// When the PC streams several points before waiting for the replies (ROS_CMD_START_SEQUENCE_CHECK),
+// the points of a connection must be added in order.  The points following a BUSY one are rejected
+// and sent again by the PC.  The first point of a trajectory (sequence 0) restarts the sequence.
+//-----------------------------------------------------------------------
+BOOL Ros_MotionServer_IsExpectedSequence(Controller* controller, int connectionIndex, int sequence)
+{
+	return (sequence == 0) || !controller->bCheckSequence[connectionIndex]
+		|| (sequence == controller->nextSequence[connectionIndex]);
+}
+
+
+//-----------------------------------------------------------------------
+// Processes message of type: ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI
+// The points are added in order, like ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX points.  Processing
+// stops at the first point that isn't accepted, e.g. because the point queue of a group is
+// full (BUSY).  This task doesn't wait for the groups, the PC sends the remaining points
+// again in its next message.
+// A single reply is sent for the whole message: the result of the last processed point,
+// with its sequence, and the number of accepted points in data[0].
+// Return -1=Failure; 0=Success; 1=CloseConnection; 
+//-----------------------------------------------------------------------
+int Ros_MotionServer_JointTrajPtFullMultiProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, 
+												 SimpleMsg* replyMsg)
+{
+	SmBodyJointTrajPtFullMulti* msgBody;
+	SmBodyJointTrajPtFullEx* point;
+	char* pointData;
+	int result, sequence, numberOfAcceptedPoints, i;
+
+	msgBody = &receiveMsg->body.jointTrajDataMulti;
+	pointData = msgBody->pointData;
+	result = ROS_RESULT_SUCCESS;
+	sequence = -1;
+	numberOfAcceptedPoints = 0;
+
+	for (i = 0; i < msgBody->numberOfPoints && result == ROS_RESULT_SUCCESS; i += 1)
+	{
+		point = (SmBodyJointTrajPtFullEx*)pointData;
+		sequence = point->sequence;
+
+		result = Ros_MotionServer_JointTrajPtFullExToGroups(controller, connectionIndex, receiveMsg, point, replyMsg);
+		if (result == ROS_RESULT_SUCCESS)
+			numberOfAcceptedPoints += 1;
+
+		pointData += Ros_MotionServer_GetJointTrajPtFullExSize(point);
+	}
+
+	replyMsg->body.motionReply.sequence = sequence;
+	replyMsg->body.motionReply.data[0] = (float)numberOfAcceptedPoints;
+
 	return 0;
 }
 
@@ -618,7 +759,7 @@ int Ros_MotionServer_JointTrajPtFullExProcess(Controller* controller, SimpleMsg*
 // Processes message of type: ROS_MSG_MOTO_MOTION_CTRL
 // Return -1=Failure; 0=Success; 1=CloseConnection; 
 //-----------------------------------------------------------------------
-int Ros_MotionServer_MotionCtrlProcess(Controller* controller, SimpleMsg* receiveMsg, 
+int Ros_MotionServer_MotionCtrlProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, 
 										SimpleMsg* replyMsg)
 {
 	SmBodyMotoMotionCtrl* motionCtrl;
@@ -705,6 +846,13 @@ int Ros_MotionServer_MotionCtrlProcess(Controller* controller, SimpleMsg* receiv
 						Ros_Controller_GetNotReadySubcode(controller), replyMsg, receiveMsg->body.motionCtrl.groupNo);
 			break;
 		}
+		case ROS_CMD_START_SEQUENCE_CHECK:
+		{
+			// Opt-in for PCs that stream several points before waiting for the replies, on this connection
+			controller->bCheckSequence[connectionIndex] = TRUE;
+			Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_SUCCESS, 0, replyMsg, receiveMsg->body.motionCtrl.groupNo);
+			break;
+		}
 		case ROS_CMD_STOP_TRAJ_MODE:
 		case ROS_CMD_DISCONNECT:
 		{
@@ -719,6 +867,11 @@ int Ros_MotionServer_MotionCtrlProcess(Controller* controller, SimpleMsg* receiv
 				Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_FAILURE, 0, replyMsg, receiveMsg->body.motionCtrl.groupNo);
 			break;
 		}
+		default:
+		{
+			Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ROS_RESULT_INVALID_COMMAND, replyMsg, receiveMsg->body.motionCtrl.groupNo);
+			break;
+		}
 	}
 
 	return 0;
@@ -1090,7 +1243,7 @@ BOOL Ros_MotionServer_StopTrajMode(Controller* controller)
 // Processes message of type: ROS_MSG_JOINT_TRAJ_PT_FULL
 // Return: 0=Success; -1=Failure
 //-----------------------------------------------------------------------
-int Ros_MotionServer_JointTrajDataProcess(Controller* controller, SimpleMsg* receiveMsg, 
+int Ros_MotionServer_JointTrajDataProcess(Controller* controller, int connectionIndex, SimpleMsg* receiveMsg, 
 											SimpleMsg* replyMsg)
 {
 	SmBodyJointTrajPtFull* trajData;
@@ -1140,7 +1293,11 @@ int Ros_MotionServer_JointTrajDataProcess(Controller* controller, SimpleMsg* rec
 	}
 
 	// Check the trajectory sequence code
-	if(trajData->sequence == 0) // First trajectory point
+	if(!Ros_MotionServer_IsExpectedSequence(controller, connectionIndex, trajData->sequence))
+	{
+		Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ROS_RESULT_INVALID_SEQUENCE, replyMsg, receiveMsg->body.jointTrajData.groupNo);
+	}
+	else if(trajData->sequence == 0) // First trajectory point
 	{
         //It's possible for energy-saving mode to activate between /robot_enable and the first trajectory point.
         Ros_MotionServer_EnsureEcoModeIsDisabled(controller); //make sure that Ros_Controller_IsMotionReady gets called above before calling this
@@ -1172,6 +1329,9 @@ int Ros_MotionServer_JointTrajDataProcess(Controller* controller, SimpleMsg* rec
 		Ros_SimpleMsg_MotionReply(receiveMsg, ROS_RESULT_INVALID, ROS_RESULT_INVALID_SEQUENCE, replyMsg, receiveMsg->body.jointTrajData.groupNo);
 	}
 
+	if(replyMsg->body.motionReply.result == ROS_RESULT_SUCCESS)
+		controller->nextSequence[connectionIndex] = trajData->sequence + 1;
+
 	return 0;
 }
 
@@ -1293,13 +1453,13 @@ int Ros_MotionServer_AddTrajPointFull(CtrlGroup* ctrlGroup, SmBodyJointTrajPtFul
 	int i;
 	JointMotionData jointData;
 
-	// Check that there isn't data current being processed
-	if(ctrlGroup->hasDataToProcess)
+	// Check that there is room for the point in the queue of points to process
+	if(ctrlGroup->trajPt_q.cnt >= TRAJ_PT_Q_SIZE)
 	{
 		// Busy
 		return ROS_RESULT_BUSY;
 	}
-	
+
 	// Convert message data to a jointMotionData
 	Ros_MotionServer_ConvertToJointMotionData(jointTrajData, &jointData);
 			
@@ -1324,9 +1484,9 @@ int Ros_MotionServer_AddTrajPointFull(CtrlGroup* ctrlGroup, SmBodyJointTrajPtFul
 		}
 	}			
 
-	// Store of the message trajectory data to the control group for processing 
-	memcpy(&ctrlGroup->jointMotionDataToProcess, &jointData, sizeof(JointMotionData));
-	ctrlGroup->hasDataToProcess = TRUE;
+	// Queue the message trajectory data to the control group for processing 
+	if(!Ros_MotionServer_AddTrajPointToQ(ctrlGroup, &jointData))
+		return ROS_RESULT_BUSY;
 
 	return 0;
 }
@@ -1348,17 +1508,17 @@ void Ros_MotionServer_AddToIncQueueProcess(Controller* controller, int groupNo)
 
 	FOREVER
 	{
-		// if there is no message to process delay and try agsain
-		if(ctrlGroup->hasDataToProcess)
+		// Take the next queued point, the points are processed back to back
+		if(Ros_MotionServer_GetTrajPointFromQ(ctrlGroup))
 		{
 			// Interpolate increment move to reach position data
 			Ros_MotionServer_JointTrajDataToIncQueue(controller, groupNo);
-			
-			// Mark message as processed 
-			ctrlGroup->hasDataToProcess = FALSE;
 		}
-		
-		Ros_Sleep(interpolPeriod);
+		else
+		{
+			// if there is no point to process delay and try again
+			Ros_Sleep(interpolPeriod);
+		}
 	}		
 }
 
@@ -1552,6 +1712,93 @@ BOOL Ros_MotionServer_AddPulseIncPointToQ(Controller* controller, int groupNo, I
 }
 
 
+//-------------------------------------------------------------------
+// Adds a trajectory point at the end of the queue of points to process
+//-------------------------------------------------------------------
+BOOL Ros_MotionServer_AddTrajPointToQ(CtrlGroup* ctrlGroup, JointMotionData* dataToEnQ)
+{
+	int index;
+	BOOL bRet = FALSE;
+	JointMotionData_q* q = &ctrlGroup->trajPt_q;
+
+	// Lock the q before manipulating it
+	if(mpSemTake(q->q_lock, Q_LOCK_TIMEOUT) == OK)
+	{
+		if(q->cnt < TRAJ_PT_Q_SIZE)
+		{
+			// Copy data at the end of the queue
+			index = Q_OFFSET_IDX( q->idx, q->cnt, TRAJ_PT_Q_SIZE );
+			q->data[index] = *dataToEnQ;
+			q->cnt++;
+			ctrlGroup->hasDataToProcess = TRUE;
+			bRet = TRUE;
+		}
+
+		// Unlock the q
+		mpSemGive(q->q_lock);
+	}
+	else
+		printf("ERROR: Unable to add trajectory point to queue.  Queue is locked up!\r\n");
+
+	return bRet;
+}
+
+
+//-------------------------------------------------------------------
+// Moves the first point of the trajectory point queue to jointMotionDataToProcess.
+// Returns FALSE and marks the previous point as processed if the queue is empty.
+//-------------------------------------------------------------------
+BOOL Ros_MotionServer_GetTrajPointFromQ(CtrlGroup* ctrlGroup)
+{
+	BOOL bRet = FALSE;
+	JointMotionData_q* q = &ctrlGroup->trajPt_q;
+
+	// Lock the q before manipulating it
+	if(mpSemTake(q->q_lock, Q_LOCK_TIMEOUT) == OK)
+	{
+		if(q->cnt > 0)
+		{
+			// Remove data from the start of the queue
+			ctrlGroup->jointMotionDataToProcess = q->data[q->idx];
+			q->idx = Q_OFFSET_IDX( q->idx, 1, TRAJ_PT_Q_SIZE );
+			q->cnt--;
+			bRet = TRUE;
+		}
+		else
+			ctrlGroup->hasDataToProcess = FALSE;
+
+		// Unlock the q
+		mpSemGive(q->q_lock);
+	}
+
+	return bRet;
+}
+
+
+//-------------------------------------------------------------------
+// Discards the trajectory points that haven't been processed yet
+//-------------------------------------------------------------------
+BOOL Ros_MotionServer_ClearTrajPointQ(CtrlGroup* ctrlGroup)
+{
+	JointMotionData_q* q = &ctrlGroup->trajPt_q;
+
+	// Lock the q before manipulating it
+	if(mpSemTake(q->q_lock, Q_LOCK_TIMEOUT) == OK)
+	{
+		// Reset the queue.  No need to modify index or delete data
+		q->cnt = 0;
+		ctrlGroup->hasDataToProcess = FALSE;
+
+		// Unlock the q
+		mpSemGive(q->q_lock);
+
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+
 //-------------------------------------------------------------------
 // Clears the inc move queue
 //-------------------------------------------------------------------
@@ -1564,7 +1811,7 @@ BOOL Ros_MotionServer_ClearQ(Controller* controller, int groupNo)
 		return FALSE;
 
 	// Stop addtional items from being added to the queue
-	controller->ctrlGroups[groupNo]->hasDataToProcess = FALSE;
+	Ros_MotionServer_ClearTrajPointQ(controller->ctrlGroups[groupNo]);
 
 	// Set pointer to specified queue
 	q = &controller->ctrlGroups[groupNo]->inc_q;
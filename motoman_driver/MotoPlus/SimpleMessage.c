@@ -53,6 +53,10 @@ int Ros_SimpleMsg_JointFeedback(CtrlGroup* ctrlGroup, SimpleMsg* sendMsg)
 	int bRet;
 	long pulsePos[MAX_PULSE_AXES];
 	long pulseSpeed[MAX_PULSE_AXES];
+	UINT32 tickMs;
+	
+	//sample time, the controller uptime wrapped at ROS_FEEDBACK_TIME_WRAP_MS
+	tickMs = (UINT32)tickGet() * (UINT32)mpGetRtc();
 	
 	//initialize memory
 	memset(sendMsg, 0x00, sizeof(SimpleMsg));
@@ -67,7 +71,8 @@ int Ros_SimpleMsg_JointFeedback(CtrlGroup* ctrlGroup, SimpleMsg* sendMsg)
 	
 	// set body
 	sendMsg->body.jointFeedback.groupNo = ctrlGroup->groupNo;
-	sendMsg->body.jointFeedback.validFields = Valid_Position;
+	sendMsg->body.jointFeedback.validFields = Valid_Time | Valid_Position;
+	sendMsg->body.jointFeedback.time = (float)(tickMs % ROS_FEEDBACK_TIME_WRAP_MS) / 1000.0f;
 	
 	//feedback position
 	bRet = Ros_CtrlGroup_GetFBPulsePos(ctrlGroup, pulsePos);
@@ -150,6 +155,12 @@ int Ros_SimpleMsg_MotionReply(SimpleMsg* receiveMsg, int result, int subcode, Si
 		replyMsg->body.motionReply.sequence = receiveMsg->body.jointTrajDataEx.sequence;
 		replyMsg->body.motionReply.command = ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX;
 	}
+	else if (receiveMsg->header.msgType == ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI)
+	{
+		// sequence of the first point; the message handler replaces it by the sequence of the last processed point
+		replyMsg->body.motionReply.sequence = ((SmBodyJointTrajPtFullEx*)receiveMsg->body.jointTrajDataMulti.pointData)->sequence;
+		replyMsg->body.motionReply.command = ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI;
+	}
 	else if (receiveMsg->header.msgType == ROS_MSG_MOTO_SELECT_TOOL)
 	{
 		replyMsg->body.motionReply.sequence = receiveMsg->body.selectTool.sequence;
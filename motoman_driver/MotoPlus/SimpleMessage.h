@@ -34,6 +34,8 @@
 
 #define ROS_MAX_JOINT 10
 #define MOT_MAX_GR	4
+#define ROS_MAX_TRAJ_PTS_PER_MSG	7	// Maximum number of points in a ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI message (as many single group points as fit in pointData)
+#define ROS_FEEDBACK_TIME_WRAP_MS	0x100000	// Period (ms) of the controller time in feedback messages, keeps the float time accurate to 0.1 ms
 
 
 //----------------
@@ -77,7 +79,8 @@ typedef enum
 	ROS_MSG_MOTO_JOINT_FEEDBACK_EX = 2017,
 	ROS_MSG_MOTO_SELECT_TOOL = 2018,
 
-	ROS_MSG_MOTO_GET_DH_PARAMETERS = 2020
+	ROS_MSG_MOTO_GET_DH_PARAMETERS = 2020,
+	ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI = 2021
 } SmMsgType;
 
 
@@ -108,7 +111,8 @@ typedef enum
 	ROS_CMD_RESET_ALARM = 200114, // clears the error in the current controller
 	ROS_CMD_START_TRAJ_MODE = 200121,
 	ROS_CMD_STOP_TRAJ_MODE = 200122,
-	ROS_CMD_DISCONNECT = 200130
+	ROS_CMD_DISCONNECT = 200130,
+	ROS_CMD_START_SEQUENCE_CHECK = 200131 // reject trajectory points of this connection that are not the next in sequence, until it closes
 } SmCommandType;
 
 
@@ -260,6 +264,13 @@ struct _SmBodyJointTrajPtFullEx
 } __attribute__((__packed__));
 typedef struct _SmBodyJointTrajPtFullEx SmBodyJointTrajPtFullEx;
 
+struct _SmBodyJointTrajPtFullMulti	// ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI = 2021
+{
+	int numberOfPoints;			// Number of trajectory points in pointData (1 to ROS_MAX_TRAJ_PTS_PER_MSG)
+	char pointData[2 * sizeof(SmBodyJointTrajPtFullEx)];	// SmBodyJointTrajPtFullEx points, back to back.  Each point only holds its numberOfValidGroups groups.
+} __attribute__((__packed__));
+typedef struct _SmBodyJointTrajPtFullMulti SmBodyJointTrajPtFullMulti;
+
 
 struct _SmBodyJointFeedbackEx
 {
@@ -397,6 +408,7 @@ typedef union
 	SmBodyMotoMotionCtrl motionCtrl;
 	SmBodyMotoMotionReply motionReply;
 	SmBodyJointTrajPtFullEx jointTrajDataEx;
+	SmBodyJointTrajPtFullMulti jointTrajDataMulti;
 	SmBodyJointFeedbackEx jointFeedbackEx;
 	SmBodySelectTool selectTool;
 	SmBodyMotoReadIOBit readIOBit;
@@ -0,0 +1,367 @@
+// MotoPlus.h
+//
+/*
+* Software License Agreement (BSD License)
+*
+* Copyright (c) 2026, the motoman_driver contributors
+* All rights reserved.
+*
+* Redistribution and use in binary form, with or without modification,
+* is permitted provided that the following conditions are met:
+*
+*       * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*       * Neither the name of the Yaskawa America, Inc., nor the names
+*       of its contributors may be used to endorse or promote products derived
+*       from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Stand-in for the MotoPlus SDK header, used to build MotoROS as a Linux
+// process (see mpSim.c). Only the subset of the API that MotoROS uses is
+// declared; structure layouts follow the SDK field names but not its sizes.
+
+#ifndef MOTOPLUS_SIM_H
+#define MOTOPLUS_SIM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-----------------------
+// VxWorks types
+//-----------------------
+typedef int				STATUS;
+typedef int				BOOL;
+typedef char			CHAR;
+typedef unsigned char	UCHAR;
+typedef short			SHORT;
+typedef unsigned short	USHORT;
+typedef int32_t		LONG;
+typedef uint32_t		ULONG;
+typedef int				INT32;
+typedef unsigned int	UINT32;
+typedef unsigned short	UINT16;
+typedef void*			SEM_ID;
+typedef int				(*FUNCPTR)();
+
+#ifndef TRUE
+#define TRUE	1
+#endif
+#ifndef FALSE
+#define FALSE	0
+#endif
+#define OK		0
+#define ERROR	(-1)
+#define NG		(-1)
+#define ON		1
+#define OFF		0
+#define FOREVER	for (;;)
+
+#ifndef max
+#define max(x, y)	(((x) < (y)) ? (y) : (x))
+#endif
+#ifndef min
+#define min(x, y)	(((x) < (y)) ? (x) : (y))
+#endif
+
+#define WAIT_FOREVER	(-1)
+#define NO_WAIT			0
+#define SEM_Q_FIFO		0x00
+#define SEM_Q_PRIORITY	0x01
+#define SEM_EMPTY		0
+#define SEM_FULL		1
+
+// VxWorks names the select() set with a structure tag
+struct fd_set
+{
+	fd_set set;
+};
+#undef FD_ZERO
+#undef FD_SET
+#undef FD_CLR
+#undef FD_ISSET
+#define FD_ZERO(p)			memset((p), 0, sizeof(struct fd_set))
+#define FD_SET(fd, p)		mpSimFdSet((fd), (p))
+#define FD_CLR(fd, p)		mpSimFdClr((fd), (p))
+#define FD_ISSET(fd, p)		mpSimFdIsSet((fd), (p))
+
+extern void mpSimFdSet(int fd, struct fd_set* fds);
+extern void mpSimFdClr(int fd, struct fd_set* fds);
+extern int mpSimFdIsSet(int fd, struct fd_set* fds);
+
+// MotoROS declares setsockopt() with the VxWorks prototype
+#define setsockopt	mpSimSetsockopt
+
+//-----------------------
+// Controller definitions
+//-----------------------
+#define MP_GRP_NUM				32
+#define MP_GRP_AXES_NUM			8
+#define MAX_PULSE_AXES			8
+#define MAX_JOB_NAME_LEN		33
+
+#define MP_STACK_SIZE			(64 * 1024)
+#define MP_PRI_IP_CLK_TAKE		2
+#define MP_PRI_TIME_CRITICAL	5
+#define MP_PRI_TIME_NORMAL		6
+#define MP_INTERPOLATION_CLK	0
+
+#define MP_USER_LAN1	1	/* general LAN interface1 */
+#define MP_USER_LAN2	2	/* general LAN interface2(only YRC1000) */
+
+#define MP_SL_ID1		0
+#define MP_SL_ID2		1
+
+typedef enum
+{
+	MP_R1_GID = 0,
+	MP_R2_GID = 1,
+	MP_R3_GID = 2,
+	MP_R4_GID = 3,
+	MP_B1_GID = 8,
+	MP_B2_GID = 9,
+	MP_B3_GID = 10,
+	MP_B4_GID = 11,
+	MP_S1_GID = 16,
+	MP_S2_GID = 17,
+	MP_S3_GID = 18
+} MP_GRP_ID_TYPE;
+
+typedef LONG MP_GRP_AXES_T[MP_GRP_NUM][MP_GRP_AXES_NUM];
+typedef LONG MP_TRQCTL_DATA[MP_GRP_NUM][MP_GRP_AXES_NUM];
+
+#define TRQ_PERCENTAGE		0
+#define TRQ_NEWTON_METER	1
+
+typedef struct
+{
+	int unit;
+	MP_TRQCTL_DATA data;
+} MP_TRQ_CTL_VAL;
+
+// Position data types of MP_POS_TAG data[3]
+#define MP_INC_PULSE_DTYPE	0x10
+
+// mpExRcsIncrementMove error codes
+#define E_EXRCS_CTRL_GRP		(-1)
+#define E_EXRCS_IMOV_UNREADY	(-3)
+
+//-----------------------
+// API structures
+//-----------------------
+typedef struct
+{
+	USHORT err_no;
+	UCHAR reserved[2];
+} MP_STD_RSP_DATA;
+
+typedef struct
+{
+	ULONG ulAddr;
+} MP_IO_INFO;
+
+typedef struct
+{
+	ULONG ulAddr;
+	ULONG ulValue;
+} MP_IO_DATA;
+
+typedef struct
+{
+	CHAR AppName[32];
+	CHAR Version[32];
+	CHAR Comment[32];
+} MP_APPINFO_SEND_DATA;
+
+typedef struct
+{
+	SHORT sCtrlGrp;
+	CHAR reserved[2];
+} MP_CTRL_GRP_SEND_DATA;
+
+typedef struct
+{
+	LONG lPos[MP_GRP_AXES_NUM];
+} MP_PULSE_POS_RSP_DATA;
+
+typedef MP_PULSE_POS_RSP_DATA MP_FB_PULSE_POS_RSP_DATA;
+
+typedef struct
+{
+	LONG lSpeed[MP_GRP_AXES_NUM];
+} MP_SERVO_SPEED_RSP_DATA;
+
+typedef struct
+{
+	SHORT sServoPower;
+	CHAR reserved[2];
+} MP_SERVO_POWER_SEND_DATA;
+
+typedef struct
+{
+	SHORT sRobotNo;
+	SHORT sToolNo;
+} MP_SET_TOOL_NO_SEND_DATA;
+
+typedef struct
+{
+	SHORT sTaskNo;
+	CHAR cJobName[MAX_JOB_NAME_LEN];
+	CHAR reserved[3];
+} MP_START_JOB_SEND_DATA;
+
+typedef struct
+{
+	SHORT sIsAlarm;
+	CHAR reserved[2];
+} MP_ALARM_STATUS_RSP_DATA;
+
+#define MP_ALARM_MAX	4
+
+typedef struct
+{
+	USHORT usAlarmNo[MP_ALARM_MAX];
+	USHORT usAlarmData[MP_ALARM_MAX];
+} MP_ALARM_DATA;
+
+typedef struct
+{
+	USHORT usErrorNo;
+	USHORT usErrorData;
+	USHORT usAlarmNum;
+	CHAR reserved[2];
+	MP_ALARM_DATA AlarmData;
+} MP_ALARM_CODE_RSP_DATA;
+
+typedef struct
+{
+	LONG data[8];
+} MP_POS_TAG;
+
+typedef struct
+{
+	MP_POS_TAG pos_tag;
+	LONG pos[MP_GRP_AXES_NUM];
+} MP_GRP_POS_INFO;
+
+typedef struct
+{
+	LONG ctrl_grp;
+	LONG m_ctrl_grp;
+	LONG s_ctrl_grp;
+	MP_GRP_POS_INFO grp_pos_info[MP_GRP_NUM];
+} MP_EXPOS_DATA;
+
+typedef MP_EXPOS_DATA MP_POS_DATA;
+
+//-----------------------
+// API functions
+//-----------------------
+
+// Tasks and timing
+extern int mpCreateTask(int priority, int stackSize, FUNCPTR entryPt,
+						int arg1, int arg2, int arg3, int arg4, int arg5,
+						int arg6, int arg7, int arg8, int arg9, int arg10);
+extern STATUS mpDeleteTask(int tid);
+extern void mpSimExitTask(void);
+#define mpDeleteSelf	mpSimExitTask()
+#define mpExitUsrRoot	mpSimExitTask()
+extern STATUS mpTaskDelay(int ticks);
+extern int mpGetRtc(void);
+extern ULONG tickGet(void);
+extern int mpClkAnnounce(int clkType);
+
+// Semaphores
+extern SEM_ID mpSemBCreate(int options, int initialState);
+extern STATUS mpSemTake(SEM_ID semId, int timeout);
+extern STATUS mpSemGive(SEM_ID semId);
+
+// Memory
+extern void* mpMalloc(size_t nBytes);
+extern void mpFree(void* ptr);
+
+// Sockets
+extern int mpSocket(int domain, int type, int protocol);
+extern int mpBind(int sd, struct sockaddr* addr, int addrLen);
+extern int mpListen(int sd, int backlog);
+extern int mpAccept(int sd, struct sockaddr* addr, int* addrLen);
+extern int mpSelect(int width, struct fd_set* readFds, struct fd_set* writeFds, struct fd_set* exceptFds, struct timeval* timeout);
+extern int mpRecv(int sd, char* buf, int bufLen, int flags);
+extern int mpSend(int sd, char* buf, int bufLen, int flags);
+extern int mpSendTo(int sd, char* buf, int bufLen, int flags, struct sockaddr* to, int toLen);
+extern STATUS mpClose(int sd);
+extern STATUS mpSetsockopt(int sd, int level, int optName, char* optVal, int optLen);
+extern STATUS mpSimSetsockopt(int sd, int level, int optName, char* optVal, int optLen);
+extern USHORT mpHtons(USHORT hostShort);
+extern int mpNICData(USHORT if_no, ULONG* ip_addr, ULONG* subnet_mask, UCHAR* mac_addr, ULONG* default_gw);
+
+// I/O
+extern LONG mpReadIO(MP_IO_INFO* sData, USHORT* rData, LONG num);
+extern LONG mpWriteIO(MP_IO_DATA* sData, LONG num);
+
+// Motion and servo
+extern int mpCtrlGrpId2GrpNo(MP_GRP_ID_TYPE grpId);
+extern LONG mpGetPulsePos(MP_CTRL_GRP_SEND_DATA* sData, MP_PULSE_POS_RSP_DATA* rData);
+extern LONG mpGetFBPulsePos(MP_CTRL_GRP_SEND_DATA* sData, MP_FB_PULSE_POS_RSP_DATA* rData);
+extern LONG mpGetServoSpeed(MP_CTRL_GRP_SEND_DATA* sData, MP_SERVO_SPEED_RSP_DATA* rData);
+extern LONG mpSvsGetVelTrqFb(MP_GRP_AXES_T dst_vel, MP_TRQ_CTL_VAL* dst_trq);
+extern int mpExRcsIncrementMove(MP_EXPOS_DATA* src_p);
+extern int mpMeiIncrementMove(int sl_id, MP_POS_DATA* src_p);
+extern LONG mpSetServoPower(MP_SERVO_POWER_SEND_DATA* sData, MP_STD_RSP_DATA* rData);
+extern LONG mpSetToolNo(MP_SET_TOOL_NO_SEND_DATA* sData, MP_STD_RSP_DATA* rData);
+extern LONG mpStartJob(MP_START_JOB_SEND_DATA* sData, MP_STD_RSP_DATA* rData);
+
+// Alarms
+extern LONG mpGetAlarmStatus(MP_ALARM_STATUS_RSP_DATA* rData);
+extern LONG mpGetAlarmCode(MP_ALARM_CODE_RSP_DATA* rData);
+extern LONG mpResetAlarm(MP_STD_RSP_DATA* rData);
+extern LONG mpCancelError(MP_STD_RSP_DATA* rData);
+extern int mpSetAlarm(short alm_code, char* alm_msg, UCHAR sub_code);
+extern LONG mpApplicationInfoNotify(MP_APPINFO_SEND_DATA* sData, MP_STD_RSP_DATA* rData);
+
+// Application entry point (mpMain.c)
+extern void mpUsrRoot(int arg1, int arg2, int arg3, int arg4, int arg5, int arg6, int arg7, int arg8, int arg9, int arg10);
+
+//-----------------------
+// Simulated controller configuration (mpSim.c)
+//-----------------------
+#define SIM_AXES_PER_GROUP		6
+#define SIM_PULSE_PER_RAD		(65536.0 / M_PI)	// 2^16 pulses per half turn
+#define SIM_MAX_SPEED_DEG		(360)				// maximum joint speed (deg/s)
+#define SIM_PULSE_LIMIT			(2 * 65536)			// +/- one full turn
+
+extern int mpSimNumGroups;			// number of simulated robot groups (R1..R4)
+extern UINT16 mpSimInterpolPeriod;	// interpolation period (ms)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
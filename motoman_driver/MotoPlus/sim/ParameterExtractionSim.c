@@ -0,0 +1,199 @@
+// ParameterExtractionSim.c
+//
+/*
+* Software License Agreement (BSD License)
+*
+* Copyright (c) 2026, the motoman_driver contributors
+* All rights reserved.
+*
+* Redistribution and use in binary form, with or without modification,
+* is permitted provided that the following conditions are met:
+*
+*       * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*       * Neither the name of the Yaskawa America, Inc., nor the names
+*       of its contributors may be used to endorse or promote products derived
+*       from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Replacement for the ParameterExtraction library on the simulated
+// controller: every group is a 6-axis rotary robot with identical axes.
+
+#include "MotoPlus.h"
+#include "ParameterExtraction.h"
+
+static BOOL Sim_IsValidGroup(int ctrlGrp)
+{
+	return (ctrlGrp >= 0) && (ctrlGrp < mpSimNumGroups);
+}
+
+int GP_getNumberOfGroups()
+{
+	return mpSimNumGroups;
+}
+
+int GP_getNumberOfAxes(int ctrlGrp)
+{
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return -1;
+	return SIM_AXES_PER_GROUP;
+}
+
+STATUS GP_getPulseToRad(int ctrlGrp, PULSE_TO_RAD *PulseToRad)
+{
+	int i;
+
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	memset(PulseToRad, 0x00, sizeof(PULSE_TO_RAD));
+	for (i = 0; i < SIM_AXES_PER_GROUP; i++)
+		PulseToRad->PtoR[i] = SIM_PULSE_PER_RAD;
+	return OK;
+}
+
+STATUS GP_getPulseToMeter(int ctrlGrp, PULSE_TO_METER* PulseToMeter)
+{
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	memset(PulseToMeter, 0x00, sizeof(PULSE_TO_METER));
+	return OK;
+}
+
+STATUS GP_getFBPulseCorrection(int ctrlGrp, FB_PULSE_CORRECTION_DATA *correctionData)
+{
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	memset(correctionData, 0x00, sizeof(FB_PULSE_CORRECTION_DATA));
+	return OK;
+}
+
+STATUS GP_getQtyOfAllowedTasks(TASK_QTY_INFO *taskInfo)
+{
+	taskInfo->qtyOfOutFiles = 16;
+	taskInfo->qtyOfHighPriorityTasks = 4;
+	taskInfo->qtyOfNormalPriorityTasks = 16;
+	return OK;
+}
+
+STATUS GP_getInterpolationPeriod(UINT16* periodInMilliseconds)
+{
+	*periodInMilliseconds = mpSimInterpolPeriod;
+	return OK;
+}
+
+STATUS GP_getMaxIncPerIpCycle(int ctrlGrp, int interpolationPeriodInMilliseconds, MAX_INCREMENT_INFO *mip)
+{
+	int i;
+
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	memset(mip, 0x00, sizeof(MAX_INCREMENT_INFO));
+	for (i = 0; i < SIM_AXES_PER_GROUP; i++)
+	{
+		mip->maxIncrement[i] = (UINT32)(SIM_MAX_SPEED_DEG * (M_PI / 180.0) * SIM_PULSE_PER_RAD
+										* interpolationPeriodInMilliseconds / 1000.0);
+	}
+	return OK;
+}
+
+float GP_getGovForIncMotion(int ctrlGrp)
+{
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return -1;
+	return 1.0;
+}
+
+STATUS GP_getJointPulseLimits(int ctrlGrp, JOINT_PULSE_LIMITS* jointPulseLimits)
+{
+	int i;
+
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	memset(jointPulseLimits, 0x00, sizeof(JOINT_PULSE_LIMITS));
+	for (i = 0; i < SIM_AXES_PER_GROUP; i++)
+	{
+		jointPulseLimits->maxLimit[i] = SIM_PULSE_LIMIT;
+		jointPulseLimits->minLimit[i] = -SIM_PULSE_LIMIT;
+	}
+	return OK;
+}
+
+STATUS GP_getJointAngularVelocityLimits(int ctrlGrp, JOINT_ANGULAR_VELOCITY_LIMITS* jointVelocityLimits)
+{
+	int i;
+
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	memset(jointVelocityLimits, 0x00, sizeof(JOINT_ANGULAR_VELOCITY_LIMITS));
+	for (i = 0; i < SIM_AXES_PER_GROUP; i++)
+		jointVelocityLimits->maxLimit[i] = SIM_MAX_SPEED_DEG;
+	return OK;
+}
+
+STATUS GP_getAxisMotionType(int ctrlGrp, AXIS_MOTION_TYPE* axisType)
+{
+	int i;
+
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	for (i = 0; i < MAX_PULSE_AXES; i++)
+		axisType->type[i] = (i < SIM_AXES_PER_GROUP) ? AXIS_ROTATION : AXIS_INVALID;
+	return OK;
+}
+
+STATUS GP_isBaxisSlave(int ctrlGrp, BOOL* bBaxisIsSlave)
+{
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	*bBaxisIsSlave = FALSE;
+	return OK;
+}
+
+STATUS GP_getFeedbackSpeedMRegisterAddresses(int ctrlGrp, BOOL bActivateIfNotEnabled, BOOL bForceRebootAfterActivation, JOINT_FEEDBACK_SPEED_ADDRESSES* registerAddresses)
+{
+	// The simulated servo does not publish its speed in M registers
+	(void)ctrlGrp;
+	(void)bActivateIfNotEnabled;
+	(void)bForceRebootAfterActivation;
+	memset(registerAddresses, 0x00, sizeof(JOINT_FEEDBACK_SPEED_ADDRESSES));
+	return NG;
+}
+
+STATUS GP_isSdaRobot(BOOL* bIsSda)
+{
+	*bIsSda = FALSE;
+	return OK;
+}
+
+STATUS GP_isSharedBaseAxis(BOOL* bIsSharedBaseAxis)
+{
+	*bIsSharedBaseAxis = FALSE;
+	return OK;
+}
+
+STATUS GP_getDhParameters(int ctrlGrp, DH_PARAMETERS* dh)
+{
+	if (!Sim_IsValidGroup(ctrlGrp))
+		return NG;
+	memset(dh, 0x00, sizeof(DH_PARAMETERS));
+	return OK;
+}
+
+STATUS GP_isPflEnabled(BOOL* bIsPflEnabled)
+{
+	*bIsPflEnabled = FALSE;
+	return OK;
+}
@@ -0,0 +1,5 @@
+// motoPlus.h
+//
+// Some MotoROS sources include the SDK header with this spelling.
+
+#include "MotoPlus.h"
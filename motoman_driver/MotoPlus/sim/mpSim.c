@@ -0,0 +1,847 @@
+// mpSim.c
+//
+/*
+* Software License Agreement (BSD License)
+*
+* Copyright (c) 2026, the motoman_driver contributors
+* All rights reserved.
+*
+* Redistribution and use in binary form, with or without modification,
+* is permitted provided that the following conditions are met:
+*
+*       * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*       * Neither the name of the Yaskawa America, Inc., nor the names
+*       of its contributors may be used to endorse or promote products derived
+*       from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Linux implementation of the MotoPlus API subset used by MotoROS.
+//
+// The unmodified MotoROS sources link against this file to run as a regular
+// process serving the motion, state and I/O ports (50240-50242):
+// - tasks are pthreads and semaphores are mutex/condition pairs
+// - sockets map one-to-one on the POSIX calls
+// - a servo thread ticks at the interpolation period; it applies the
+//   increments of mpExRcsIncrementMove to the command position, and the
+//   feedback position follows the command one tick later
+// - I/O is a flat array of signals; the INIT_ROS job is emulated by
+//   mpStartJob and by watching IO_FEEDBACK_MP_INCMOVE_DONE
+//
+// Task priorities are ignored and one RTC tick is one millisecond.
+
+#define _GNU_SOURCE
+#include "MotoROS.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#undef setsockopt
+
+#define SIM_MAX_TASKS			64
+#define SIM_MIN_STACK_SIZE		(1024 * 1024)
+#define SIM_IO_ADDR_MAX			1100000
+#define SIM_MAX_GROUPS			4
+
+// Status inputs read by Ros_Controller_StatusInit
+#define SIM_IO_ALARM_USER		50013
+#define SIM_IO_PLAY				50054
+#define SIM_IO_OPERATING		50070
+#define SIM_IO_SERVO			50073
+#define SIM_IO_REMOTE			80011
+#define SIM_IO_ESTOP_EX			80025
+#define SIM_IO_ESTOP_PP			80026
+#define SIM_IO_ESTOP_CTRL		80027
+
+//-----------------------
+// Type definitions
+//-----------------------
+typedef void (*SimTaskEntry)(long, long, long, long, long, long, long, long, long, long);
+
+typedef struct
+{
+	BOOL bInUse;
+	BOOL bFinished;
+	pthread_t thread;
+	void* stack;
+	size_t stackSize;
+	FUNCPTR entryPt;
+	int args[10];
+} SimTask;
+
+typedef struct
+{
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	BOOL bFull;
+} SimSem;
+
+typedef struct
+{
+	LONG cmdPos[MP_GRP_AXES_NUM];		// command position (pulse)
+	LONG fbPos[MP_GRP_AXES_NUM];		// feedback position (pulse)
+	LONG fbSpeed[MP_GRP_AXES_NUM];		// feedback speed (pulse/sec)
+	LONG pendingInc[MP_GRP_AXES_NUM];	// increment applied at the next tick
+} SimGroup;
+
+//-----------------------
+// Global data
+//-----------------------
+int mpSimNumGroups = 1;
+UINT16 mpSimInterpolPeriod = 4;
+
+static SimTask simTasks[SIM_MAX_TASKS];
+static pthread_mutex_t simTaskLock = PTHREAD_MUTEX_INITIALIZER;
+static __thread int simSelfTid = INVALID_TASK;
+
+static pthread_mutex_t simServoLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t simClkCond;
+static unsigned long simClkTick;
+static SimGroup simGroups[SIM_MAX_GROUPS];
+
+static pthread_mutex_t simIoLock = PTHREAD_MUTEX_INITIALIZER;
+static USHORT simIo[SIM_IO_ADDR_MAX];
+static USHORT simAlarmCode;
+
+//-----------------------
+// Helpers
+//-----------------------
+static void Sim_MutexUnlock(void* mutex)
+{
+	pthread_mutex_unlock((pthread_mutex_t*)mutex);
+}
+
+static void Sim_CondInit(pthread_cond_t* cond)
+{
+	pthread_condattr_t attr;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+static void Sim_AddMilliseconds(struct timespec* ts, long milliseconds)
+{
+	ts->tv_sec += milliseconds / 1000;
+	ts->tv_nsec += (milliseconds % 1000) * 1000000L;
+	if (ts->tv_nsec >= 1000000000L)
+	{
+		ts->tv_sec += 1;
+		ts->tv_nsec -= 1000000000L;
+	}
+}
+
+static int Sim_GroupIndex(SHORT sCtrlGrp)
+{
+	// sCtrlGrp is the value of MP_GRP_ID_TYPE; only robot groups are simulated
+	if (sCtrlGrp >= MP_R1_GID && sCtrlGrp < MP_R1_GID + mpSimNumGroups)
+		return sCtrlGrp - MP_R1_GID;
+	return -1;
+}
+
+// Must be called with simIoLock held
+static void Sim_SetJobRunning(BOOL bRunning)
+{
+	simIo[SIM_IO_OPERATING] = bRunning;
+	simIo[IO_FEEDBACK_WAITING_MP_INCMOVE] = bRunning;
+	if (bRunning)
+		simIo[IO_FEEDBACK_MP_INCMOVE_DONE] = 0;
+}
+
+//-----------------------
+// Tasks
+//-----------------------
+static void Sim_TaskCleanup(void* arg)
+{
+	SimTask* task = (SimTask*)arg;
+
+	pthread_mutex_lock(&simTaskLock);
+	task->bFinished = TRUE;
+	pthread_mutex_unlock(&simTaskLock);
+}
+
+static void* Sim_TaskStart(void* arg)
+{
+	SimTask* task = (SimTask*)arg;
+	int* a = task->args;
+
+	simSelfTid = (int)(task - simTasks) + 1;
+
+	pthread_cleanup_push(Sim_TaskCleanup, task);
+	// MotoROS passes pointers as int, so extend the arguments back to
+	// register width before calling the entry point
+	((SimTaskEntry)(void*)task->entryPt)(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9]);
+	pthread_cleanup_pop(1);
+	return NULL;
+}
+
+// Must be called with simTaskLock held
+static void Sim_TaskRelease(SimTask* task)
+{
+	pthread_join(task->thread, NULL);
+	munmap(task->stack, task->stackSize);
+	memset(task, 0x00, sizeof(SimTask));
+}
+
+int mpCreateTask(int priority, int stackSize, FUNCPTR entryPt,
+				 int arg1, int arg2, int arg3, int arg4, int arg5,
+				 int arg6, int arg7, int arg8, int arg9, int arg10)
+{
+	int i;
+	int tid = ERROR;
+	int cancelState;
+	SimTask* task;
+	pthread_attr_t attr;
+
+	(void)priority;	// the tasks are scheduled by Linux
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancelState);
+	pthread_mutex_lock(&simTaskLock);
+
+	for (i = 0; i < SIM_MAX_TASKS; i++)
+	{
+		task = &simTasks[i];
+		if (task->bInUse && task->bFinished)
+			Sim_TaskRelease(task);
+		if (!task->bInUse)
+			break;
+	}
+	if (i == SIM_MAX_TASKS)
+		goto exitCreateTask;
+
+	// The stack lives in the low 2GB so that the address of a local variable
+	// (such as the Controller of RosInitTask) survives the cast to int
+	task->stackSize = (stackSize < SIM_MIN_STACK_SIZE) ? SIM_MIN_STACK_SIZE : stackSize;
+	task->stack = mmap(NULL, task->stackSize, PROT_READ | PROT_WRITE,
+					   MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_32BIT, -1, 0);
+	if (task->stack == MAP_FAILED)
+		goto exitCreateTask;
+
+	task->entryPt = entryPt;
+	task->args[0] = arg1; task->args[1] = arg2; task->args[2] = arg3; task->args[3] = arg4;
+	task->args[4] = arg5; task->args[5] = arg6; task->args[6] = arg7; task->args[7] = arg8;
+	task->args[8] = arg9; task->args[9] = arg10;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setstack(&attr, task->stack, task->stackSize);
+	if (pthread_create(&task->thread, &attr, Sim_TaskStart, task) == 0)
+	{
+		task->bInUse = TRUE;
+		tid = i + 1;
+	}
+	else
+	{
+		munmap(task->stack, task->stackSize);
+		memset(task, 0x00, sizeof(SimTask));
+	}
+	pthread_attr_destroy(&attr);
+
+exitCreateTask:
+	pthread_mutex_unlock(&simTaskLock);
+	pthread_setcancelstate(cancelState, NULL);
+	return tid;
+}
+
+STATUS mpDeleteTask(int tid)
+{
+	STATUS status = ERROR;
+	int cancelState;
+
+	if (tid == simSelfTid)
+		mpSimExitTask();
+
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancelState);
+	pthread_mutex_lock(&simTaskLock);
+	if (tid >= 1 && tid <= SIM_MAX_TASKS && simTasks[tid - 1].bInUse)
+	{
+		if (!simTasks[tid - 1].bFinished)
+			pthread_cancel(simTasks[tid - 1].thread);
+		status = OK;
+	}
+	pthread_mutex_unlock(&simTaskLock);
+	pthread_setcancelstate(cancelState, NULL);
+	return status;
+}
+
+void mpSimExitTask(void)
+{
+	pthread_exit(NULL);
+}
+
+STATUS mpTaskDelay(int ticks)
+{
+	struct timespec ts;
+
+	if (ticks <= 0)
+		return sched_yield();
+
+	ts.tv_sec = ticks / 1000;
+	ts.tv_nsec = (ticks % 1000) * 1000000L;
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+		;
+	return OK;
+}
+
+int mpGetRtc(void)
+{
+	return 1;
+}
+
+ULONG tickGet(void)
+{
+	struct timespec now;
+
+	// ticks are 1 ms (see mpGetRtc)
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (ULONG)now.tv_sec * 1000UL + (ULONG)(now.tv_nsec / 1000000L);
+}
+
+int mpClkAnnounce(int clkType)
+{
+	unsigned long tick;
+
+	(void)clkType;	// all clocks are the interpolation clock
+	pthread_mutex_lock(&simServoLock);
+	pthread_cleanup_push(Sim_MutexUnlock, &simServoLock);
+	tick = simClkTick;
+	while (tick == simClkTick)
+		pthread_cond_wait(&simClkCond, &simServoLock);
+	pthread_cleanup_pop(1);
+	return OK;
+}
+
+//-----------------------
+// Semaphores
+//-----------------------
+SEM_ID mpSemBCreate(int options, int initialState)
+{
+	SimSem* sem = (SimSem*)malloc(sizeof(SimSem));
+
+	(void)options;
+	if (sem == NULL)
+		return NULL;
+	pthread_mutex_init(&sem->lock, NULL);
+	Sim_CondInit(&sem->cond);
+	sem->bFull = (initialState == SEM_FULL);
+	return (SEM_ID)sem;
+}
+
+STATUS mpSemTake(SEM_ID semId, int timeout)
+{
+	SimSem* sem = (SimSem*)semId;
+	struct timespec deadline;
+	volatile STATUS status = OK;	// set between pthread_cleanup_push and pthread_cleanup_pop
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	if (timeout > 0)
+		Sim_AddMilliseconds(&deadline, timeout * mpGetRtc());
+
+	pthread_mutex_lock(&sem->lock);
+	pthread_cleanup_push(Sim_MutexUnlock, &sem->lock);
+	while (!sem->bFull)
+	{
+		if (timeout == NO_WAIT)
+		{
+			status = ERROR;
+			break;
+		}
+		if (timeout == WAIT_FOREVER)
+			pthread_cond_wait(&sem->cond, &sem->lock);
+		else if (pthread_cond_timedwait(&sem->cond, &sem->lock, &deadline) == ETIMEDOUT)
+		{
+			status = ERROR;
+			break;
+		}
+	}
+	if (status == OK)
+		sem->bFull = FALSE;
+	pthread_cleanup_pop(1);
+	return status;
+}
+
+STATUS mpSemGive(SEM_ID semId)
+{
+	SimSem* sem = (SimSem*)semId;
+
+	pthread_mutex_lock(&sem->lock);
+	sem->bFull = TRUE;
+	pthread_cond_signal(&sem->cond);
+	pthread_mutex_unlock(&sem->lock);
+	return OK;
+}
+
+//-----------------------
+// Memory
+//-----------------------
+void* mpMalloc(size_t nBytes)
+{
+	return malloc(nBytes);
+}
+
+void mpFree(void* ptr)
+{
+	free(ptr);
+}
+
+//-----------------------
+// Sockets
+//-----------------------
+void mpSimFdSet(int fd, struct fd_set* fds)
+{
+	__FDS_BITS(&fds->set)[fd / NFDBITS] |= (__fd_mask)1 << (fd % NFDBITS);
+}
+
+void mpSimFdClr(int fd, struct fd_set* fds)
+{
+	__FDS_BITS(&fds->set)[fd / NFDBITS] &= ~((__fd_mask)1 << (fd % NFDBITS));
+}
+
+int mpSimFdIsSet(int fd, struct fd_set* fds)
+{
+	return (__FDS_BITS(&fds->set)[fd / NFDBITS] & ((__fd_mask)1 << (fd % NFDBITS))) != 0;
+}
+
+int mpSocket(int domain, int type, int protocol)
+{
+	int sd;
+	int reuse = 1;
+
+	sd = socket(domain, type, protocol);
+	// allow the simulator to be restarted while old connections linger
+	if (sd >= 0 && type == SOCK_STREAM)
+		mpSimSetsockopt(sd, SOL_SOCKET, SO_REUSEADDR, (char*)&reuse, sizeof(reuse));
+	return sd;
+}
+
+int mpBind(int sd, struct sockaddr* addr, int addrLen)
+{
+	return bind(sd, addr, addrLen);
+}
+
+int mpListen(int sd, int backlog)
+{
+	return listen(sd, backlog);
+}
+
+int mpAccept(int sd, struct sockaddr* addr, int* addrLen)
+{
+	socklen_t len = sizeof(struct sockaddr_in);
+	int ret;
+
+	ret = accept(sd, addr, &len);
+	if (addrLen != NULL)
+		*addrLen = len;
+	return ret;
+}
+
+int mpSelect(int width, struct fd_set* readFds, struct fd_set* writeFds, struct fd_set* exceptFds, struct timeval* timeout)
+{
+	return select(width,
+				  readFds ? &readFds->set : NULL,
+				  writeFds ? &writeFds->set : NULL,
+				  exceptFds ? &exceptFds->set : NULL,
+				  timeout);
+}
+
+int mpRecv(int sd, char* buf, int bufLen, int flags)
+{
+	return recv(sd, buf, bufLen, flags);
+}
+
+int mpSend(int sd, char* buf, int bufLen, int flags)
+{
+	return send(sd, buf, bufLen, flags | MSG_NOSIGNAL);
+}
+
+int mpSendTo(int sd, char* buf, int bufLen, int flags, struct sockaddr* to, int toLen)
+{
+	return sendto(sd, buf, bufLen, flags | MSG_NOSIGNAL, to, toLen);
+}
+
+STATUS mpClose(int sd)
+{
+	return close(sd);
+}
+
+STATUS mpSetsockopt(int sd, int level, int optName, char* optVal, int optLen)
+{
+	return mpSimSetsockopt(sd, level, optName, optVal, optLen);
+}
+
+STATUS mpSimSetsockopt(int sd, int level, int optName, char* optVal, int optLen)
+{
+	// debug.c passes the VxWorks value of SO_BROADCAST
+	if (level == SOL_SOCKET && optName == 0x0020)
+		optName = SO_BROADCAST;
+	return setsockopt(sd, level, optName, optVal, optLen);
+}
+
+USHORT mpHtons(USHORT hostShort)
+{
+	return htons(hostShort);
+}
+
+int mpNICData(USHORT if_no, ULONG* ip_addr, ULONG* subnet_mask, UCHAR* mac_addr, ULONG* default_gw)
+{
+	(void)if_no;	// every interface is the loopback interface
+	*ip_addr = htonl(INADDR_LOOPBACK);
+	*subnet_mask = htonl(0xFF000000);
+	*default_gw = 0;
+	memset(mac_addr, 0x00, 6);
+	return OK;
+}
+
+//-----------------------
+// I/O
+//-----------------------
+LONG mpReadIO(MP_IO_INFO* sData, USHORT* rData, LONG num)
+{
+	LONG i;
+	LONG ret = 0;
+
+	pthread_mutex_lock(&simIoLock);
+	for (i = 0; i < num; i++)
+	{
+		if (sData[i].ulAddr >= SIM_IO_ADDR_MAX)
+		{
+			rData[i] = 0;
+			ret = -1;
+		}
+		else
+			rData[i] = simIo[sData[i].ulAddr];
+	}
+	pthread_mutex_unlock(&simIoLock);
+	return ret;
+}
+
+LONG mpWriteIO(MP_IO_DATA* sData, LONG num)
+{
+	LONG i;
+	LONG ret = 0;
+
+	pthread_mutex_lock(&simIoLock);
+	for (i = 0; i < num; i++)
+	{
+		if (sData[i].ulAddr >= SIM_IO_ADDR_MAX)
+		{
+			ret = -1;
+			continue;
+		}
+		simIo[sData[i].ulAddr] = (USHORT)sData[i].ulValue;
+
+		// INIT_ROS waits for this signal, then ends
+		if (sData[i].ulAddr == IO_FEEDBACK_MP_INCMOVE_DONE && sData[i].ulValue && simIo[SIM_IO_OPERATING])
+			Sim_SetJobRunning(FALSE);
+	}
+	pthread_mutex_unlock(&simIoLock);
+	return ret;
+}
+
+//-----------------------
+// Motion and servo
+//-----------------------
+int mpCtrlGrpId2GrpNo(MP_GRP_ID_TYPE grpId)
+{
+	return Sim_GroupIndex(grpId);
+}
+
+LONG mpGetPulsePos(MP_CTRL_GRP_SEND_DATA* sData, MP_PULSE_POS_RSP_DATA* rData)
+{
+	int grp = Sim_GroupIndex(sData->sCtrlGrp);
+
+	if (grp < 0)
+		return -1;
+	pthread_mutex_lock(&simServoLock);
+	memcpy(rData->lPos, simGroups[grp].cmdPos, sizeof(rData->lPos));
+	pthread_mutex_unlock(&simServoLock);
+	return 0;
+}
+
+LONG mpGetFBPulsePos(MP_CTRL_GRP_SEND_DATA* sData, MP_FB_PULSE_POS_RSP_DATA* rData)
+{
+	int grp = Sim_GroupIndex(sData->sCtrlGrp);
+
+	if (grp < 0)
+		return -1;
+	pthread_mutex_lock(&simServoLock);
+	memcpy(rData->lPos, simGroups[grp].fbPos, sizeof(rData->lPos));
+	pthread_mutex_unlock(&simServoLock);
+	return 0;
+}
+
+LONG mpGetServoSpeed(MP_CTRL_GRP_SEND_DATA* sData, MP_SERVO_SPEED_RSP_DATA* rData)
+{
+	int grp = Sim_GroupIndex(sData->sCtrlGrp);
+
+	if (grp < 0)
+		return -1;
+	pthread_mutex_lock(&simServoLock);
+	memcpy(rData->lSpeed, simGroups[grp].fbSpeed, sizeof(rData->lSpeed));
+	pthread_mutex_unlock(&simServoLock);
+	return 0;
+}
+
+LONG mpSvsGetVelTrqFb(MP_GRP_AXES_T dst_vel, MP_TRQ_CTL_VAL* dst_trq)
+{
+	int grp;
+	int axis;
+
+	pthread_mutex_lock(&simServoLock);
+	for (grp = 0; grp < mpSimNumGroups; grp++)
+	{
+		for (axis = 0; axis < MP_GRP_AXES_NUM; axis++)
+			dst_vel[grp][axis] = simGroups[grp].fbSpeed[axis] * 10; //0.1 pulse/sec
+	}
+	pthread_mutex_unlock(&simServoLock);
+
+	if (dst_trq != NULL)
+		memset(dst_trq->data, 0x00, sizeof(MP_TRQCTL_DATA));
+	return OK;
+}
+
+int mpExRcsIncrementMove(MP_EXPOS_DATA* src_p)
+{
+	int grp;
+	int axis;
+	BOOL bReady;
+
+	pthread_mutex_lock(&simIoLock);
+	bReady = simIo[SIM_IO_SERVO] && simIo[SIM_IO_OPERATING];
+	pthread_mutex_unlock(&simIoLock);
+	if (!bReady)
+		return E_EXRCS_IMOV_UNREADY;
+
+	if (src_p->ctrl_grp & ~((1L << mpSimNumGroups) - 1))
+		return E_EXRCS_CTRL_GRP;
+
+	pthread_mutex_lock(&simServoLock);
+	for (grp = 0; grp < mpSimNumGroups; grp++)
+	{
+		if (src_p->ctrl_grp & (1L << grp))
+		{
+			for (axis = 0; axis < MP_GRP_AXES_NUM; axis++)
+				simGroups[grp].pendingInc[axis] += src_p->grp_pos_info[grp].pos[axis];
+		}
+	}
+	pthread_mutex_unlock(&simServoLock);
+	return 0;
+}
+
+int mpMeiIncrementMove(int sl_id, MP_POS_DATA* src_p)
+{
+	(void)sl_id;
+	return mpExRcsIncrementMove(src_p);
+}
+
+// Interpolation clock and servo model
+static void* Sim_ServoTask(void* arg)
+{
+	struct timespec next;
+	int grp;
+	int axis;
+	LONG prevFbPos;
+
+	(void)arg;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	FOREVER
+	{
+		Sim_AddMilliseconds(&next, mpSimInterpolPeriod);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR)
+			;
+
+		pthread_mutex_lock(&simServoLock);
+		for (grp = 0; grp < mpSimNumGroups; grp++)
+		{
+			SimGroup* g = &simGroups[grp];
+			for (axis = 0; axis < MP_GRP_AXES_NUM; axis++)
+			{
+				prevFbPos = g->fbPos[axis];
+				g->fbPos[axis] = g->cmdPos[axis];
+				g->fbSpeed[axis] = (g->fbPos[axis] - prevFbPos) * 1000 / mpSimInterpolPeriod;
+				g->cmdPos[axis] += g->pendingInc[axis];
+				g->pendingInc[axis] = 0;
+			}
+		}
+		simClkTick++;
+		pthread_cond_broadcast(&simClkCond);
+		pthread_mutex_unlock(&simServoLock);
+	}
+	return NULL;
+}
+
+LONG mpSetServoPower(MP_SERVO_POWER_SEND_DATA* sData, MP_STD_RSP_DATA* rData)
+{
+	pthread_mutex_lock(&simIoLock);
+	simIo[SIM_IO_SERVO] = (sData->sServoPower != OFF);
+	if (sData->sServoPower == OFF)
+		Sim_SetJobRunning(FALSE);
+	pthread_mutex_unlock(&simIoLock);
+
+	rData->err_no = 0;
+	return 0;
+}
+
+LONG mpSetToolNo(MP_SET_TOOL_NO_SEND_DATA* sData, MP_STD_RSP_DATA* rData)
+{
+	(void)sData;
+	rData->err_no = 0;
+	return 0;
+}
+
+LONG mpStartJob(MP_START_JOB_SEND_DATA* sData, MP_STD_RSP_DATA* rData)
+{
+	LONG ret = 0;
+
+	(void)sData;	// there is only one job
+	pthread_mutex_lock(&simIoLock);
+	rData->err_no = 0;
+	if (simIo[SIM_IO_OPERATING])
+		rData->err_no = 0x2010; //Robot is in operation
+	else if (simIo[SIM_IO_ALARM_USER])
+		rData->err_no = 0x2060; //In ERROR/ALARM status
+	else if (!simIo[SIM_IO_SERVO])
+		rData->err_no = 0x2070; //In SERVO OFF status
+	else
+		Sim_SetJobRunning(TRUE);
+	pthread_mutex_unlock(&simIoLock);
+
+	if (rData->err_no != 0)
+		ret = -1;
+	return ret;
+}
+
+//-----------------------
+// Alarms
+//-----------------------
+LONG mpGetAlarmStatus(MP_ALARM_STATUS_RSP_DATA* rData)
+{
+	pthread_mutex_lock(&simIoLock);
+	rData->sIsAlarm = simIo[SIM_IO_ALARM_USER] ? MASK_ISALARM_ACTIVEALARM : 0;
+	pthread_mutex_unlock(&simIoLock);
+	return 0;
+}
+
+LONG mpGetAlarmCode(MP_ALARM_CODE_RSP_DATA* rData)
+{
+	memset(rData, 0x00, sizeof(MP_ALARM_CODE_RSP_DATA));
+	pthread_mutex_lock(&simIoLock);
+	if (simIo[SIM_IO_ALARM_USER])
+	{
+		rData->usAlarmNum = 1;
+		rData->AlarmData.usAlarmNo[0] = simAlarmCode;
+	}
+	pthread_mutex_unlock(&simIoLock);
+	return 0;
+}
+
+LONG mpResetAlarm(MP_STD_RSP_DATA* rData)
+{
+	pthread_mutex_lock(&simIoLock);
+	simIo[SIM_IO_ALARM_USER] = 0;
+	simAlarmCode = 0;
+	pthread_mutex_unlock(&simIoLock);
+
+	rData->err_no = 0;
+	return 0;
+}
+
+LONG mpCancelError(MP_STD_RSP_DATA* rData)
+{
+	rData->err_no = 0;
+	return 0;
+}
+
+int mpSetAlarm(short alm_code, char* alm_msg, UCHAR sub_code)
+{
+	printf("ALARM %d[%d]: %s\r\n", alm_code, sub_code, alm_msg);
+
+	pthread_mutex_lock(&simIoLock);
+	simIo[SIM_IO_ALARM_USER] = 1;
+	simAlarmCode = alm_code;
+	Sim_SetJobRunning(FALSE);
+	pthread_mutex_unlock(&simIoLock);
+	return 0;
+}
+
+LONG mpApplicationInfoNotify(MP_APPINFO_SEND_DATA* sData, MP_STD_RSP_DATA* rData)
+{
+	printf("%s %s (%s)\r\n", sData->AppName, sData->Version, sData->Comment);
+	rData->err_no = 0;
+	return 0;
+}
+
+//-----------------------
+// Simulator entry point
+//-----------------------
+static void Sim_Usage(const char* name)
+{
+	printf("Usage: %s [-g groups] [-i interpolation_period_ms]\r\n", name);
+	printf("  Runs MotoROS on a simulated controller (ports %d-%d).\r\n", TCP_PORT_MOTION, TCP_PORT_IO);
+}
+
+int main(int argc, char** argv)
+{
+	int opt;
+	pthread_t servoThread;
+
+	while ((opt = getopt(argc, argv, "g:i:h")) != -1)
+	{
+		switch (opt)
+		{
+		case 'g':
+			mpSimNumGroups = atoi(optarg);
+			break;
+		case 'i':
+			mpSimInterpolPeriod = (UINT16)atoi(optarg);
+			break;
+		default:
+			Sim_Usage(argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+	if (mpSimNumGroups < 1 || mpSimNumGroups > SIM_MAX_GROUPS || mpSimInterpolPeriod < 1)
+	{
+		Sim_Usage(argv[0]);
+		return 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	// Controller in REMOTE PLAY mode, no E-stop, servo off
+	simIo[SIM_IO_PLAY] = 1;
+	simIo[SIM_IO_REMOTE] = 1;
+	simIo[SIM_IO_ESTOP_EX] = 1;
+	simIo[SIM_IO_ESTOP_PP] = 1;
+	simIo[SIM_IO_ESTOP_CTRL] = 1;
+
+	Sim_CondInit(&simClkCond);
+	if (pthread_create(&servoThread, NULL, Sim_ServoTask, NULL) != 0)
+	{
+		perror("pthread_create");
+		return 1;
+	}
+
+	printf("Simulated controller: %d group(s), %d ms interpolation period\r\n",
+		   mpSimNumGroups, mpSimInterpolPeriod);
+	mpUsrRoot(0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MOTOMAN_DRIVER_BENCHMARK_SAMPLES_H
+#define MOTOMAN_DRIVER_BENCHMARK_SAMPLES_H
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+namespace motoman
+{
+namespace benchmark
+{
+
+/**
+ * \brief Collection of samples, reported as a distribution
+ */
+class Samples
+{
+public:
+  void add(double value)
+  {
+    values_.push_back(value);
+  }
+
+  void add(const Samples &other)
+  {
+    values_.insert(values_.end(), other.values_.begin(), other.values_.end());
+  }
+
+  size_t size() const
+  {
+    return values_.size();
+  }
+
+  void toJson(std::ostream &os) const
+  {
+    if (values_.empty())
+    {
+      os << "{\"count\": 0}";
+      return;
+    }
+
+    std::vector<double> sorted = values_;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (size_t i = 0; i < sorted.size(); ++i)
+      sum += sorted[i];
+    const double mean = sum / sorted.size();
+    double sq_sum = 0.0;
+    for (size_t i = 0; i < sorted.size(); ++i)
+      sq_sum += (sorted[i] - mean) * (sorted[i] - mean);
+
+    os << "{\"count\": " << sorted.size()
+       << ", \"mean\": " << mean
+       << ", \"stddev\": " << std::sqrt(sq_sum / sorted.size())
+       << ", \"min\": " << sorted.front()
+       << ", \"p50\": " << percentile(sorted, 0.50)
+       << ", \"p90\": " << percentile(sorted, 0.90)
+       << ", \"p99\": " << percentile(sorted, 0.99)
+       << ", \"max\": " << sorted.back() << "}";
+  }
+
+private:
+  static double percentile(const std::vector<double> &sorted, double p)
+  {
+    const size_t idx = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(std::max(idx, static_cast<size_t>(1)), sorted.size()) - 1];
+  }
+
+  std::vector<double> values_;
+};
+
+}  // namespace benchmark
+}  // namespace motoman
+
+#endif  // MOTOMAN_DRIVER_BENCHMARK_SAMPLES_H
@@ -0,0 +1,159 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MOTOMAN_DRIVER_INDUSTRIAL_ROBOT_CLIENT_CLOCK_SYNC_H
+#define MOTOMAN_DRIVER_INDUSTRIAL_ROBOT_CLIENT_CLOCK_SYNC_H
+
+#include <ros/ros.h>
+
+namespace industrial_robot_client
+{
+namespace clock_sync
+{
+
+/**
+ * \brief Maps controller time onto the host clock.
+ *
+ * Fits host receive time against controller sample time with an exponentially weighted
+ * linear regression, which follows the offset and drift between the clocks.  Transport
+ * delays only ever make packets late, so the fit is then shifted down to the lower envelope
+ * of the residuals: the fastest recent packets are taken to have arrived without delay.
+ * The latency reported is therefore the delay of a packet beyond the fastest ones, the
+ * one-way delay itself can't be observed from one side.
+ *
+ * When the controller time goes backwards, or disagrees with the estimate by more than the
+ * reset threshold, the estimate starts over.
+ */
+class ClockSync
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param time_constant time (s) over which old samples are forgotten
+   * \param max_drift largest believable drift rate (s/s) between the clocks
+   * \param reset_threshold residual (s) beyond which the controller time is taken to have jumped
+   * \param envelope_rise rate (s/s) at which the lower envelope forgets a fast packet
+   */
+  explicit ClockSync(double time_constant = 10.0, double max_drift = 1e-3, double reset_threshold = 0.5,
+                     double envelope_rise = 1e-3);
+
+  /**
+   * \brief Adds a sample, and returns its time on the host clock
+   *
+   * \param controller_time controller time of the sample (s)
+   * \param receive_time host time the sample was received at
+   *
+   * \return time of the sample on the host clock.  Samples with the same controller time get
+   * the same stamp, unless the controller time stops advancing, which returns receive_time.
+   */
+  ros::Time update(double controller_time, const ros::Time &receive_time);
+
+  /**
+   * \brief Forgets all samples
+   */
+  void reset();
+
+  /**
+   * \brief Returns the offset (s) of the host clock from the controller clock, at the last sample
+   */
+  double getOffset() const
+  {
+    return offset_;
+  }
+
+  /**
+   * \brief Returns the rate (s/s) the host clock runs faster than the controller clock at
+   */
+  double getDrift() const
+  {
+    return rate_ - 1.0;
+  }
+
+  /**
+   * \brief Returns the delay (s) of the last sample beyond the fastest recent ones
+   */
+  double getLatency() const
+  {
+    return latency_;
+  }
+
+  /**
+   * \brief Returns the number of times the estimate started over
+   */
+  unsigned int getResets() const
+  {
+    return resets_;
+  }
+
+private:
+  double time_constant_;
+  double max_drift_;
+  double reset_threshold_;
+  double envelope_rise_;
+
+  /**
+   * \brief Sample the estimate started from, all times below are relative to it
+   */
+  bool initialized_;
+  double base_controller_time_;
+  ros::Time base_receive_time_;
+
+  /**
+   * \brief Controller time, receive time and host time of the last sample
+   */
+  double last_x_;
+  double last_y_;
+  double last_sample_y_;
+
+  /**
+   * \brief Weighted means and (co)variance of controller time (x) and receive time (y)
+   */
+  double mean_x_;
+  double mean_y_;
+  double var_x_;
+  double cov_xy_;
+
+  /**
+   * \brief Lower envelope of the residuals of the fit
+   */
+  double envelope_;
+
+  double rate_;
+  double offset_;
+  double latency_;
+  unsigned int resets_;
+};
+
+}  // namespace clock_sync
+}  // namespace industrial_robot_client
+
+#endif  // MOTOMAN_DRIVER_INDUSTRIAL_ROBOT_CLIENT_CLOCK_SYNC_H
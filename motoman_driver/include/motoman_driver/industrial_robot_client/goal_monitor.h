@@ -0,0 +1,241 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MOTOMAN_DRIVER_INDUSTRIAL_ROBOT_CLIENT_GOAL_MONITOR_H
+#define MOTOMAN_DRIVER_INDUSTRIAL_ROBOT_CLIENT_GOAL_MONITOR_H
+
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <control_msgs/FollowJointTrajectoryFeedback.h>
+#include <control_msgs/FollowJointTrajectoryGoal.h>
+#include <control_msgs/JointTolerance.h>
+
+namespace industrial_robot_client
+{
+namespace joint_trajectory_action
+{
+
+/**
+ * \brief Checks the feedback of a robot group against the goal of an action.
+ *
+ * The positions and tolerances of the goal are copied once, when the goal is accepted,
+ * into arrays in the joint order of the feedback.  Each feedback message is then checked
+ * with a single pass over contiguous values, without looking up joints by name.
+ *
+ * The streamer starts a trajectory when it receives it, after the goal is accepted, so the
+ * time of the trajectory is anchored at the first feedback in which the robot has moved
+ * (by MOTION_THRESHOLD) instead.  The path isn't checked until then.  If the robot hasn't
+ * moved by the end of the trajectory, it is anchored at the time the goal was accepted.
+ */
+class GoalMonitor
+{
+public:
+  GoalMonitor();
+
+  /**
+   * \brief Prepares the monitor for a new goal
+   *
+   * The tolerances of the goal follow control_msgs/JointTolerance: a positive value is
+   * used as is, zero selects the default of the joint, and a negative value disables the
+   * check.  Joints the goal has no tolerance for use their defaults.
+   *
+   * \param goal action goal
+   * \param joint_names joint names of the robot group, the expected order of the feedback
+   * \param accepted time the goal was accepted at
+   * \param path_tolerance default position tolerance of each joint along the trajectory,
+   * in the order of joint_names (<= 0 for none)
+   * \param goal_tolerance default position tolerance of each joint at the final point,
+   * in the order of joint_names (<= 0 for none)
+   * \param goal_time_tolerance default time allowed after the final point to reach the goal
+   * tolerances (<= 0 for no limit)
+   *
+   * \return true on success, false if the trajectory is empty, doesn't have all the joints
+   * of the group, or a point has fewer positions than joints
+   */
+  bool init(const control_msgs::FollowJointTrajectoryGoal &goal, const std::vector<std::string> &joint_names,
+            const ros::Time &accepted, const std::vector<double> &path_tolerance,
+            const std::vector<double> &goal_tolerance, double goal_time_tolerance);
+
+  /**
+   * \brief Forgets the goal
+   */
+  void clear();
+
+  /**
+   * \brief Returns true if the monitor has no goal
+   */
+  bool empty() const
+  {
+    return times_.empty();
+  }
+
+  /**
+   * \brief Compares a feedback message to the goal
+   *
+   * Fills the joint names, actual positions, desired positions (interpolated from the goal
+   * trajectory at the time of the message) and errors of feedback.  The outcome is
+   * available from withinGoal(), trajectoryEnded(), goalTimeExceeded() and pathViolation().
+   *
+   * \param state feedback message of the robot group
+   * \param feedback returns the feedback of the action
+   *
+   * \return true on success, false if the joints of state don't match the goal
+   */
+  bool update(const control_msgs::FollowJointTrajectoryFeedback &state,
+              control_msgs::FollowJointTrajectoryFeedback *feedback);
+
+  /**
+   * \brief Returns true if all joints of the last feedback were within their goal tolerances
+   */
+  bool withinGoal() const
+  {
+    return within_goal_;
+  }
+
+  /**
+   * \brief Returns true if the last feedback was at or past the time of the final point
+   */
+  bool trajectoryEnded() const
+  {
+    return trajectory_ended_;
+  }
+
+  /**
+   * \brief Returns true if the last feedback was past the final point by more than the
+   * goal time tolerance
+   */
+  bool goalTimeExceeded() const
+  {
+    return goal_time_exceeded_;
+  }
+
+  /**
+   * \brief Returns the name of a joint that was outside of its path tolerance in the last
+   * feedback, or an empty string if there was none
+   */
+  std::string pathViolation() const
+  {
+    return path_violation_ < 0 ? std::string() : joint_names_[path_violation_];
+  }
+
+private:
+  /**
+   * \brief Reorders the positions and tolerances into the joint order of names
+   *
+   * \return true on success, false if names aren't the joints of the goal
+   */
+  bool reorder(const std::vector<std::string> &names);
+
+  /**
+   * \brief Joint names, in the order of positions_ and the tolerances
+   */
+  std::vector<std::string> joint_names_;
+
+  /**
+   * \brief Positions of all points, one row of joint_names_.size() values per point
+   */
+  std::vector<double> positions_;
+
+  /**
+   * \brief Time of each point, relative to start_
+   */
+  std::vector<double> times_;
+
+  /**
+   * \brief Position tolerance along the trajectory, infinity if not checked
+   */
+  std::vector<double> path_tolerance_;
+
+  /**
+   * \brief Position tolerance at the final point, infinity if not checked
+   */
+  std::vector<double> goal_tolerance_;
+
+  /**
+   * \brief Velocity tolerance at the final point, infinity if not checked
+   */
+  std::vector<double> goal_velocity_tolerance_;
+
+  /**
+   * \brief Time allowed after the final point to reach the goal, infinity if not limited
+   */
+  double goal_time_tolerance_;
+
+  /**
+   * \brief Position change (rad) that shows the robot has started to move
+   */
+  static const double MOTION_THRESHOLD;  // = 1e-3;
+
+  /**
+   * \brief Time the goal was accepted at
+   */
+  ros::Time accepted_;
+
+  /**
+   * \brief Time of the trajectory the robot starts to move at, the last point at the first position
+   */
+  double motion_start_;
+
+  /**
+   * \brief Positions of the first feedback, in the order of joint_names_
+   */
+  std::vector<double> hold_positions_;
+
+  /**
+   * \brief true once the robot has started to move, and start_ is known
+   */
+  bool started_;
+
+  /**
+   * \brief Start time of the trajectory
+   */
+  ros::Time start_;
+
+  /**
+   * \brief Index of the first point at or after the time of the last feedback
+   */
+  size_t next_point_;
+
+  /**
+   * \brief Outcome of the last feedback
+   */
+  bool within_goal_;
+  bool trajectory_ended_;
+  bool goal_time_exceeded_;
+  int path_violation_;
+};
+
+}  // namespace joint_trajectory_action
+}  // namespace industrial_robot_client
+
+#endif  // MOTOMAN_DRIVER_INDUSTRIAL_ROBOT_CLIENT_GOAL_MONITOR_H
@@ -41,6 +41,7 @@
 #include "motoman_driver/industrial_robot_client/joint_feedback_relay_handler.h"
 #include "motoman_driver/simple_message/messages/joint_feedback_ex_message.h"
 #include "motoman_msgs/DynamicJointsGroup.h"
+#include "motoman_msgs/DynamicJointState.h"
 #include "motoman_msgs/DynamicJointTrajectoryFeedback.h"
 
 namespace industrial_robot_client
@@ -113,10 +114,18 @@ protected:
                        control_msgs::FollowJointTrajectoryFeedback* control_state,
                        sensor_msgs::JointState* sensor_state);
 
-  // override JointRelayHandler::create_messages, to check robot_id w/o error msg
-  bool create_messages(JointFeedbackMessage& msg_in,
-                       control_msgs::FollowJointTrajectoryFeedback* control_state,
-                       sensor_msgs::JointState* sensor_state, int robot_id);
+  /**
+   * \brief Publishes the feedback of one group of a controller packet
+   *
+   * \param[in] msg_in feedback of the group
+   * \param[in] stamp time stamp of the controller packet
+   * \param[in] robot_id group number
+   * \param[out] dyn_joint_state feedback of the group, for the dynamic feedback message
+   *
+   * \return true on success, false otherwise
+   */
+  bool create_messages(JointFeedbackMessage& msg_in, const ros::Time& stamp, int robot_id,
+                       motoman_msgs::DynamicJointState* dyn_joint_state);
 
 private:
   static bool JointDataToVector(const industrial::joint_data::JointData &joints,
@@ -129,6 +138,22 @@ private:
    */
   industrial::shared_types::shared_int valid_fields_from_message_;
 
+  /**
+   * \brief Published messages of each group, and the dynamic feedback message.  They are
+   * reused for every controller packet, unless a subscriber in this process still holds them.
+   */
+  std::map<int, control_msgs::FollowJointTrajectoryFeedbackPtr> control_states_;
+  std::map<int, sensor_msgs::JointStatePtr> sensor_states_;
+  motoman_msgs::DynamicJointTrajectoryFeedbackPtr dynamic_control_state_;
+
+  /**
+   * \brief Intermediate joint states, reused for every group
+   */
+  DynamicJointsGroup all_joint_state_;
+  DynamicJointsGroup xform_joint_state_;
+  DynamicJointsGroup pub_joint_state_;
+  std::vector<std::string> pub_joint_names_;
+
   /**
    * \brief Convert joint feedback message into intermediate message-type
    *
@@ -38,10 +38,12 @@
 #include <algorithm>
 #include "ros/ros.h"
 #include "control_msgs/FollowJointTrajectoryFeedback.h"
+#include "diagnostic_msgs/DiagnosticArray.h"
 #include "sensor_msgs/JointState.h"
 #include "simple_message/message_handler.h"
 #include "simple_message/messages/joint_message.h"
 #include "trajectory_msgs/JointTrajectoryPoint.h"
+#include "motoman_driver/industrial_robot_client/clock_sync.h"
 #include "motoman_driver/industrial_robot_client/robot_group.h"
 #include "motoman_msgs/DynamicJointsGroup.h"
 
@@ -67,7 +69,7 @@ public:
   /**
   * \brief Constructor
   */
-  JointRelayHandler() {}
+  JointRelayHandler() : last_controller_time_(0.0), controller_time_base_(0.0) {}
 
   typedef std::map<int, RobotGroup>::iterator it_type;
   /**
@@ -113,6 +115,41 @@ protected:
   std::map<int, ros::Publisher> pub_controls_;
   std::map<int, ros::Publisher> pub_states_;
 
+  /**
+   * \brief Maps the controller time of feedback packets onto the host clock, and
+   * publishes the estimate as a diagnostic
+   */
+  industrial_robot_client::clock_sync::ClockSync clock_sync_;
+  ros::Publisher pub_diagnostics_;
+  ros::Time last_diagnostics_;
+
+  /**
+   * \brief Period (s) of the controller time in feedback packets, MotoROS wraps it so the
+   * float field stays accurate (see ROS_FEEDBACK_TIME_WRAP_MS)
+   */
+  static const double CONTROLLER_TIME_PERIOD;  // = 1048.576;
+
+  /**
+   * \brief Last controller time received, and what was added to it to undo its wrapping
+   */
+  double last_controller_time_;
+  double controller_time_base_;
+
+  /**
+   * \brief Returns the time stamp of a controller packet
+   *
+   * The stamp is the controller time of the packet on the host clock (see ClockSync), or
+   * the time the packet is processed if it carries no controller time.  Controller time
+   * that wraps around (see CONTROLLER_TIME_PERIOD) is unwrapped first.  Publishes the
+   * clock offset, drift and latency on /diagnostics, at most once per second.
+   *
+   * \param has_time true if the packet carries controller time
+   * \param controller_time controller time of the packet (s)
+   *
+   * \return time stamp for the messages of the packet
+   */
+  ros::Time stamp_packet(bool has_time, double controller_time);
+
   /**
    * \brief Class initializer
    *
@@ -45,6 +45,7 @@
 #include <control_msgs/FollowJointTrajectoryAction.h>
 #include <control_msgs/FollowJointTrajectoryFeedback.h>
 #include <industrial_msgs/RobotStatus.h>
+#include <motoman_driver/industrial_robot_client/goal_monitor.h>
 #include <motoman_driver/industrial_robot_client/robot_group.h>
 #include <motoman_msgs/DynamicJointTrajectory.h>
 namespace industrial_robot_client
@@ -144,6 +145,16 @@ private:
 
   std::map<int, trajectory_msgs::JointTrajectory> current_traj_map_;
 
+  /**
+   * \brief Checks the feedback of each group against its active goal
+   */
+  std::map<int, GoalMonitor> goal_monitor_map_;
+
+  /**
+   * \brief Action feedback of each group, reused for every feedback message
+   */
+  std::map<int, control_msgs::FollowJointTrajectoryFeedback> action_feedback_map_;
+
   std::vector<std::string> all_joint_names_;
 
   /**
@@ -161,6 +172,22 @@ private:
    */
   double goal_threshold_;
 
+  /**
+   * \brief Default position tolerances of the joints of each group at the final point
+   * (param constraints/<joint>/goal, goal_threshold if not set) and along the trajectory
+   * (param constraints/<joint>/trajectory, not checked if not set).  Used for the joints
+   * an action goal has no tolerances for.
+   */
+  std::map<int, std::vector<double> > goal_tolerance_map_;
+
+  std::map<int, std::vector<double> > path_tolerance_map_;
+
+  /**
+   * \brief Default time allowed after the end of a trajectory to reach the goal tolerances
+   * (param constraints/goal_time, not limited if not set)
+   */
+  double goal_time_tolerance_;
+
   /**
    * \brief The joint names associated with the robot the action is
    * interfacing with.  The joint names must be the same as expected
@@ -269,6 +296,16 @@ private:
 
   void abortGoal(int robot_id);
 
+  /**
+   * \brief Aborts the active goal of a group with a result, and sends a stop command
+   * (empty message) to the robot driver.
+   *
+   * \param robot_id group number
+   * \param error_code error code of the result
+   * \param error_string description of the error
+   */
+  void abortGoal(int robot_id, int error_code, const std::string &error_string);
+
   /**
    * \brief Controller status callback (executed when robot status
    *  message received)
@@ -281,9 +318,6 @@ private:
    */
   bool withinGoalConstraints(const control_msgs::FollowJointTrajectoryFeedbackConstPtr &msg,
                              const trajectory_msgs::JointTrajectory & traj);
-
-  bool withinGoalConstraints(const control_msgs::FollowJointTrajectoryFeedbackConstPtr &msg,
-                             const trajectory_msgs::JointTrajectory & traj, int robot_id);
 };
 
 }  // namespace joint_trajectory_action
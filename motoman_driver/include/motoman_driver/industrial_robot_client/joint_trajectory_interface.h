@@ -36,6 +36,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <mutex>  // NOLINT(build/c++11)
 #include "ros/ros.h"
 #include "industrial_msgs/CmdJointTrajectory.h"
 #include "motoman_msgs/CmdJointTrajectoryEx.h"
@@ -47,6 +48,7 @@
 #include "simple_message/messages/joint_traj_pt_message.h"
 #include "trajectory_msgs/JointTrajectory.h"
 #include "motoman_driver/industrial_robot_client/robot_group.h"
+#include "motoman_driver/simple_message/timed_tcp_client.h"
 
 namespace industrial_robot_client
 {
@@ -55,6 +57,7 @@ namespace joint_trajectory_interface
 
 using industrial::smpl_msg_connection::SmplMsgConnection;
 using industrial::tcp_client::TcpClient;
+using industrial::timed_tcp_client::TimedTcpClient;
 using industrial::joint_traj_pt_message::JointTrajPtMessage;
 using industrial::simple_message::SimpleMessage;
 namespace StandardSocketPorts = industrial::simple_socket::StandardSocketPorts;
@@ -211,6 +214,45 @@ protected:
   virtual bool select(const std::vector<std::string>& ros_joint_names, const trajectory_msgs::JointTrajectoryPoint& ros_pt,
                       const std::vector<std::string>& rbt_joint_names, trajectory_msgs::JointTrajectoryPoint* rbt_pt);
 
+  /**
+   * \brief Find the ROS joint of each robot joint, to select the joints of many points by index
+   *
+   * \param[in] ros_joint_names joint names from ROS command
+   * \param[in] rbt_joint_names joint names, in order/count expected by robot connection
+   * \param[out] ros_indices index in ros_joint_names of each robot joint, -1 for unused (empty) robot joints
+   *
+   * \return true on success, false if a robot joint is not found
+   */
+  bool find_joint_indices(const std::vector<std::string>& ros_joint_names,
+                          const std::vector<std::string>& rbt_joint_names, std::vector<int>* ros_indices);
+
+  /**
+   * \brief Find the ROS joint of each joint of a robot group, see find_joint_indices()
+   *
+   * \param[in] ros_joint_names joint names from ROS command
+   * \param[in] group_number robot group
+   * \param[in,out] group_indices indices found so far, by robot group
+   *
+   * \return the indices for group_number, NULL if a joint of the group is not found
+   */
+  const std::vector<int>* find_joint_indices(const std::vector<std::string>& ros_joint_names, int group_number,
+                                             std::map<int, std::vector<int> >* group_indices);
+
+  /**
+   * \brief Select specific joints for sending to the robot
+   *
+   * \param[in] ros_indices ROS joint of each robot joint, from find_joint_indices()
+   * \param[in] ros_pt target pos/vel from ROS command
+   * \param[out] rbt_pt target pos/vel, matching the robot joints
+   *
+   * \return true on success, false otherwise
+   */
+  virtual bool select(const std::vector<int>& ros_indices, const motoman_msgs::DynamicJointsGroup& ros_pt,
+                      motoman_msgs::DynamicJointsGroup* rbt_pt);
+
+  virtual bool select(const std::vector<int>& ros_indices, const trajectory_msgs::JointTrajectoryPoint& ros_pt,
+                      trajectory_msgs::JointTrajectoryPoint* rbt_pt);
+
   /**
    * \brief Create SimpleMessage for sending to the robot
    *
@@ -249,8 +291,8 @@ protected:
   virtual bool calc_velocity(const motoman_msgs::DynamicJointsGroup& pt, double* rbt_velocity);
 
   /**
-   * \brief Compute the expected move duration for communication to the robot.
-   *   If unneeded by the robot server, set to 0 (or any value).
+   * \brief Compute the expected move duration for communication to the robot, from the previous point
+   *   of the same group a duration was computed for.  If unneeded by the robot server, set to 0 (or any value).
    *
    * \param[in] pt trajectory point data, in order/count expected by robot connection
    * \param[out] rbt_duration computed move duration for robot message (if needed by robot)
@@ -260,8 +302,18 @@ protected:
   virtual bool calc_duration(const trajectory_msgs::JointTrajectoryPoint& pt, double* rbt_duration);
 
   /**
-   * \brief Compute the expected move duration for communication to the robot.
-   *   If unneeded by the robot server, set to 0 (or any value).
+   * \brief Compute the move duration from the previous point to a point
+   *
+   * \param[in] time_from_start time of the point
+   * \param[in] last_time_from_start time of the previous point of its group
+   *
+   * \return the move duration, or the default duration if the point doesn't follow the previous one
+   */
+  double calc_duration(double time_from_start, double last_time_from_start) const;
+
+  /**
+   * \brief Compute the expected move duration for communication to the robot, from the previous point
+   *   of the same group a duration was computed for.  If unneeded by the robot server, set to 0 (or any value).
    *
    * \param[in] pt trajectory point data, in order/count expected by robot connection
    * \param[out] rbt_duration computed move duration for robot message (if needed by robot)
@@ -339,6 +391,15 @@ protected:
    */
   virtual bool is_valid(const trajectory_msgs::JointTrajectory &traj);
 
+  /**
+   * \brief Read the acceleration limits of joints, from the MoveIt joint limits
+   * (robot_description_planning/joint_limits) if they are loaded and the
+   * check_acceleration_limits parameter is set (default: false)
+   *
+   * \param joint_names joints to read the limits of
+   */
+  void load_acceleration_limits(const std::vector<std::string> &joint_names);
+
   /*
    * \brief Callback for JointState topic
    *
@@ -348,7 +409,22 @@ protected:
 
   virtual void jointStateCB(const sensor_msgs::JointStateConstPtr &msg, int robot_id);
 
-  TcpClient default_tcp_connection_;
+  /**
+   * \brief Get the last received joint state
+   *
+   * \return the joint state, or NULL if none was received yet
+   */
+  sensor_msgs::JointStateConstPtr get_cur_joint_pos();
+
+  /**
+   * \brief Get the last received joint state of a robot group
+   *
+   * \param robot_id robot group
+   * \return the joint state, or NULL if none was received yet
+   */
+  sensor_msgs::JointStateConstPtr get_cur_joint_pos(int robot_id);
+
+  TimedTcpClient default_tcp_connection_;  // no reply timeout, unless a derived class sets one
 
   ros::NodeHandle node_;
   SmplMsgConnection* connection_;
@@ -374,9 +450,12 @@ protected:
   double default_vel_ratio_;  // default velocity ratio to use for joint commands, if no velocity or max_vel specified
   double default_duration_;   // default duration to use for joint commands, if no
   std::map<std::string, double> joint_vel_limits_;  // cache of max joint velocities from URDF
-  sensor_msgs::JointState cur_joint_pos_;  // cache of last received joint state
-
-  std::map<int, sensor_msgs::JointState> cur_joint_pos_map_;
+  std::map<int, double> last_time_from_start_;  // by group (-1 for JointTrajectory points), see calc_duration()
+  std::map<std::string, double> joint_acc_limits_;  // cache of max joint accelerations, see load_acceleration_limits()
+  // last received joint states, kept as the received messages instead of copies.  Use get_cur_joint_pos().
+  sensor_msgs::JointStateConstPtr cur_joint_pos_;
+  std::map<int, sensor_msgs::JointStateConstPtr> cur_joint_pos_map_;  // has an entry for each robot group
+  std::mutex cur_joint_pos_mutex_;  // only held to swap or copy the pointers above
 
 private:
   /**
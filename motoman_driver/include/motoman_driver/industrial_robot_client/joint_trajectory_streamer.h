@@ -33,11 +33,14 @@
 #define MOTOMAN_DRIVER_INDUSTRIAL_ROBOT_CLIENT_JOINT_TRAJECTORY_STREAMER_H
 
 #include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <boost/shared_ptr.hpp>
 #include "motoman_driver/industrial_robot_client/joint_trajectory_interface.h"
+#include <atomic>  // NOLINT(build/c++11)
 #include <map>
 #include <vector>
 #include <string>
-#include <queue>
 
 namespace industrial_robot_client
 {
@@ -57,6 +60,23 @@ enum TransferState
 }
 typedef TransferStates::TransferState TransferState;
 
+/**
+ * \brief Point queued for point streaming, tagged with the streaming session it belongs to
+ */
+struct PointStreamingSlot
+{
+  int session;
+  SimpleMessage message;
+};
+
+/**
+ * \brief Trajectory serialized into the request messages sent to the robot, one per point.
+ *
+ * A trajectory is never modified once it is loaded, so the streaming thread sends its messages
+ * as they are, without copying them or holding a lock. Changing the trajectory means loading a new one.
+ */
+typedef boost::shared_ptr<std::vector<SimpleMessage> > SerializedTrajectoryPtr;
+
 /**
  * \brief Message handler that streams joint trajectories to the robot controller
  */
@@ -81,7 +101,8 @@ public:
    *
    * \param min_buffer_size minimum number of points as required by robot implementation
    */
-  explicit JointTrajectoryStreamer(int min_buffer_size = 1) : min_buffer_size_(min_buffer_size) {};
+  explicit JointTrajectoryStreamer(int min_buffer_size = 1) : current_traj_(new std::vector<SimpleMessage>()),
+    min_buffer_size_(min_buffer_size), streaming_session_(0), ptstreaming_queue_(NULL) {};
 
   /**
    * \brief Class initializer
@@ -133,20 +154,56 @@ public:
   bool send_to_robot(const std::vector<SimpleMessage>& messages);
 
 protected:
-  static const size_t max_ptstreaming_queue_elements = 20;
+  static const int default_ptstreaming_queue_size = 20;
   void trajectoryStop();
 
+  /**
+   * \brief Allocate the point streaming queue, with the size given by the
+   * point_streaming_queue_size parameter
+   */
+  void initPointStreamingQueue();
+
+  /**
+   * \brief Wake the streaming thread after queueing a point without holding mutex_
+   */
+  void notifyPointQueued();
+
+  /**
+   * \brief Turn a message into the request sent to the robot (create_message() may produce topic messages)
+   *
+   * \param[in,out] msg message to convert
+   */
+  static void makeRequest(SimpleMessage* msg);
+
+  /**
+   * \brief Serialize trajectory messages once, into the requests sent to the robot
+   *
+   * \param messages messages created by trajectory_to_msgs()
+   *
+   * \return serialized trajectory
+   */
+  static SerializedTrajectoryPtr serializeTrajectory(const std::vector<SimpleMessage>& messages);
+
   boost::thread* streaming_thread_;
   boost::mutex mutex_;
+  boost::condition_variable streaming_cond_;  // wakes the streaming thread on new trajectories, points and stops
   int current_point_;
-  std::vector<SimpleMessage> current_traj_;
+  SerializedTrajectoryPtr current_traj_;
   TransferState state_;
   ros::Time streaming_start_;
   int min_buffer_size_;
 
+  /**
+   * \brief Incremented (under mutex_) whenever a trajectory is loaded, point streaming starts or motion
+   * is stopped, so the streaming thread can discard results of I/O done without holding mutex_ and
+   * points queued for an earlier point streaming session.
+   */
+  std::atomic<int> streaming_session_;
+
   ros::Duration ptstreaming_last_time_from_start_;   // last valid point streaming point time from start
   int ptstreaming_seq_count_; // sequence count for point streaming (--> JointTrajPtFull::sequence_)
-  std::queue<SimpleMessage> ptstreaming_queue_; // message queue for point streaming
+  // message queue for point streaming, the ROS callbacks produce and the streaming thread consumes
+  boost::lockfree::spsc_queue<PointStreamingSlot>* ptstreaming_queue_;
 };
 
 }  // namespace joint_trajectory_streamer
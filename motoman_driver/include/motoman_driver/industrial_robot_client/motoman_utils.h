@@ -38,6 +38,8 @@
 #include <map>
 
 #include "motoman_driver/industrial_robot_client/robot_group.h"
+#include "motoman_msgs/DynamicJointTrajectory.h"
+#include "trajectory_msgs/JointTrajectory.h"
 
 namespace industrial_robot_client
 {
@@ -53,6 +55,26 @@ namespace motoman_utils
  */
 bool getJointGroups(const std::string topic_param, std::map<int, RobotGroup> & robot_groups);
 
+/**
+ * \brief Splits a trajectory of the joints of several groups into a trajectory of the groups
+ *
+ * Every point of the result has all robot groups.  Groups whose first joint isn't in the
+ * trajectory, and fields the trajectory has no values for, are filled with zeros.  The
+ * joints of each group are looked up once, and all points are gathered into
+ * preallocated messages by index.  The header and joint names of the result are left
+ * to the caller.
+ *
+ * \param traj trajectory of the joints of the groups
+ * \param robot_groups robot groups, by group number
+ * \param dyn_traj returns the trajectory of the robot groups
+ *
+ * \return true on success, false if a group's joints are only partly in the trajectory,
+ * or a point has fewer values than joints
+ */
+bool toDynamicJointTrajectory(const trajectory_msgs::JointTrajectory &traj,
+                              const std::map<int, RobotGroup> &robot_groups,
+                              motoman_msgs::DynamicJointTrajectory *dyn_traj);
+
 }  // namespace motoman_utils
 }  // namespace industrial_robot_client
 
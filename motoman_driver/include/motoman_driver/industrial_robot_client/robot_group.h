@@ -42,22 +42,22 @@ class RobotGroup
 public:
   RobotGroup() {}
 
-  std::vector<std::string> get_joint_names()
+  const std::vector<std::string>& get_joint_names() const
   {
     return this->joint_names_;
   }
 
-  std::string get_name()
+  const std::string& get_name() const
   {
     return this->name_;
   }
 
-  std::string get_ns()
+  const std::string& get_ns() const
   {
     return this->ns_;
   }
 
-  int get_group_id()
+  int get_group_id() const
   {
     return this->group_id_;
   }
@@ -42,6 +42,7 @@
 #include "motoman_msgs/SelectTool.h"
 #include "simple_message/joint_data.h"
 #include "simple_message/simple_message.h"
+#include "motoman_driver/simple_message/timed_tcp_client.h"
 #include "std_srvs/Trigger.h"
 
 namespace motoman
@@ -51,8 +52,11 @@ namespace joint_trajectory_streamer
 
 using motoman::motion_ctrl::MotomanMotionCtrl;
 using industrial_robot_client::joint_trajectory_streamer::JointTrajectoryStreamer;
+using industrial_robot_client::joint_trajectory_streamer::SerializedTrajectoryPtr;
 using industrial::simple_message::SimpleMessage;
 using industrial::smpl_msg_connection::SmplMsgConnection;
+using industrial::timed_tcp_client::TimedTcpClient;
+namespace StandardSocketPorts = industrial::simple_socket::StandardSocketPorts;
 
 /**
  * \brief Message handler that streams joint trajectories to the robot controller.
@@ -72,6 +76,7 @@ public:
   // these statements help find the base-class versions
   using JointTrajectoryStreamer::run;
   using JointTrajectoryStreamer::init;
+  using JointTrajectoryStreamer::jointTrajectoryCB;
   using JointTrajectoryInterface::is_valid;
 
   virtual void run();
@@ -82,10 +87,26 @@ public:
    * \param robot_id robot group # on this controller (for multi-group systems)
    */
   explicit MotomanJointTrajectoryStreamer(int robot_id = -1) : JointTrajectoryStreamer(1),
-    robot_id_(robot_id) {}
+    robot_id_(robot_id), use_control_connection_(false), control_port_(0), reply_timeout_(10.0),
+    streaming_window_size_(1),
+    streaming_points_per_message_(1) {}
 
   ~MotomanJointTrajectoryStreamer();
 
+  /**
+   * \brief Initialize robot connection using default method.
+   *
+   * \param default_ip default IP address to use for robot connection [OPTIONAL]
+   *                    - this value will be used if ROS param "robot_ip_address" cannot be read
+   * \param default_port default port to use for robot connection [OPTIONAL]
+   *                    - this value will be used if ROS param "~port" cannot be read
+   * \param version_0 unused, the configuration is read from the ROS parameters
+   *
+   * \return true on success, false otherwise
+   */
+  virtual bool init(std::string default_ip = "", int default_port = StandardSocketPorts::MOTION,
+                    bool version_0 = false);
+
   /**
    * \brief Class initializer
    *
@@ -133,6 +154,20 @@ public:
 
   virtual bool send_to_robot(const std::vector<SimpleMessage>& messages);
 
+  /**
+   * \brief Splice the trajectory into the one being streamed if possible, stop the current motion otherwise.
+   *
+   * \param msg JointTrajectory message from ROS trajectory-planner
+   */
+  virtual void jointTrajectoryCB(const trajectory_msgs::JointTrajectoryConstPtr &msg);
+
+  /**
+   * \brief Splice the trajectory into the one being streamed if possible, stop the current motion otherwise.
+   *
+   * \param msg DynamicJointTrajectory message from ROS trajectory-planner
+   */
+  virtual void jointTrajectoryExCB(const motoman_msgs::DynamicJointTrajectoryConstPtr &msg);
+
   virtual void streamingThread();
 
 protected:
@@ -150,6 +185,124 @@ protected:
 
   std::map<int, MotomanMotionCtrl> motion_ctrl_map_;
 
+  /**
+   * \brief Publishes the transfer state (robot_transfer_state), periodically while run() spins.
+   */
+  ros::Publisher transfer_state_pub_;
+  void publishTransferState(const ros::TimerEvent &e);
+
+  /**
+   * \brief Send the motion control commands (motion_ctrl_) on a connection of their own, so they neither wait
+   * for nor delay the trajectory points being streamed (ROS parameter: motion_control_connection, default: false).
+   *
+   * Requires a MotoROS version that accepts more than one motion server connection, as the one in this
+   * package does, and the streamer to be initialized with the controller address.
+   */
+  bool use_control_connection_;
+  TimedTcpClient control_connection_;
+  std::mutex control_conx_mutex_;  // serializes access to control_connection_
+  std::string control_ip_;
+  int control_port_;
+
+  /**
+   * \brief Time to wait for the reply to a request, before closing the connection and reconnecting (ROS
+   * parameter: motion_reply_timeout, default: 10.0 s, <= 0 waits indefinitely).
+   *
+   * Bounds how long a stalled controller can block the streaming thread, and the motion control commands
+   * waiting for the connection.  Starting trajectory mode waits up to 5 s for the servos to power on.
+   */
+  double reply_timeout_;
+
+  /**
+   * \brief Set up the connection used by motion_ctrl_, according to the motion_control_connection parameter.
+   *
+   * \param connection connection the trajectory points are streamed on
+   *
+   * \return the control connection, or connection if there is no separate one
+   */
+  SmplMsgConnection* initControlConnection(SmplMsgConnection* connection);
+
+  /**
+   * \brief Lock the connection used by motion_ctrl_, reconnecting it if it was closed.
+   */
+  std::unique_lock<std::mutex> lockControlConnection();
+
+  /**
+   * \brief Number of trajectory points sent to the controller before waiting for
+   * their replies (ROS parameter: streaming_window_size, default: 1).
+   *
+   * Windows larger than 1 require a MotoROS version that rejects out-of-order
+   * trajectory points (INVALID/SEQUENCE) after a START_SEQUENCE_CHECK command,
+   * as the one in this package does. With other versions, the streamer falls
+   * back to a window of 1. The window is limited to the 8 points MotoROS
+   * queues per group (TRAJ_PT_Q_SIZE).
+   */
+  int streaming_window_size_;
+
+  /**
+   * \brief Send the next window of trajectory points and process their replies.
+   *
+   * \param lock lock on mutex_, released while communicating with the controller
+   * \param[out] busy set to true if the controller rejected a point because it was busy
+   *
+   * \return true if all points of the window were sent and replied to, false otherwise
+   */
+  bool streamPointWindow(boost::unique_lock<boost::mutex>& lock, bool* busy);
+
+  /**
+   * \brief Number of trajectory points sent to the controller in a single JointTrajPtFullMulti
+   * message (ROS parameter: streaming_points_per_message, default: 1). Fewer points are sent if
+   * they don't fit in a message.
+   *
+   * More than 1 requires a MotoROS version that supports ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI,
+   * as the one in this package does. Takes precedence over streaming_window_size.
+   *
+   * MotoROS doesn't wait for busy groups while processing the message, it accepts the points up to
+   * the first one that doesn't fit in the point queue of its groups (TRAJ_PT_Q_SIZE points).
+   *
+   * The message size limits the number of points: 7 points of 1 group, 3 of 2 groups, 2 of 3 groups
+   * but a single point of 4 groups (e.g. a point of all groups of an SDA10F), see JointTrajPtFullMulti.
+   */
+  int streaming_points_per_message_;
+
+  /**
+   * \brief Send the next trajectory points in a single message and process its reply.
+   *
+   * \param lock lock on mutex_, released while communicating with the controller
+   * \param[out] busy set to true if the controller didn't accept all points because it was busy
+   *
+   * \return true if the message was sent and replied to, false otherwise
+   */
+  bool streamPointBatch(boost::unique_lock<boost::mutex>& lock, bool* busy);
+
+  /**
+   * \brief ROS trajectory the points in current_traj_ were created from, used to find where a new
+   * trajectory can be spliced in. Only the one matching the type of the last loaded trajectory is set.
+   */
+  trajectory_msgs::JointTrajectoryConstPtr current_ros_traj_;
+  motoman_msgs::DynamicJointTrajectoryConstPtr current_ros_traj_ex_;
+
+  /**
+   * \brief Merge a trajectory into current_traj_, continuing the current motion without stopping.
+   *
+   * The new trajectory must start at the position and velocity of a point of the current trajectory that
+   * wasn't sent to the controller yet. It replaces the current trajectory from that point on, with sequence
+   * numbers and time_from_start continuing those of the current trajectory. Points before the splice point,
+   * including the ones already queued on the controller, are kept.
+   *
+   * \param traj trajectory to splice in
+   *
+   * \return true if the trajectory was spliced in, false if it doesn't fit the current trajectory
+   */
+  bool spliceTrajectory(const trajectory_msgs::JointTrajectory &traj);
+  bool spliceTrajectory(const motoman_msgs::DynamicJointTrajectory &traj);
+
+  /**
+   * \brief Index of the first point of current_traj_ that is not being sent to the controller
+   * (must be called with mutex_ held)
+   */
+  size_t firstUnsentPoint() const;
+
   void trajectoryStop();
   bool is_valid(const trajectory_msgs::JointTrajectory &traj);
   bool is_valid(const motoman_msgs::DynamicJointTrajectory &traj);
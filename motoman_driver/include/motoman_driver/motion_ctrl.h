@@ -65,6 +65,15 @@ public:
   bool setTrajMode(bool enable);
   bool stopTrajectory();
 
+  /**
+   * \brief Make the controller reject trajectory points that are not the next in
+   * sequence, until the connection closes. Required for streaming several points
+   * before waiting for their replies.
+   *
+   * \return True IFF the controller supports and enabled the sequence check
+   */
+  bool startSequenceCheck();
+
   /**
    * \brief Change the active tool file on the controller.
    *
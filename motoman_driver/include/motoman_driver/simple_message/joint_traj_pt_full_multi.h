@@ -0,0 +1,171 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MOTOMAN_DRIVER_SIMPLE_MESSAGE_JOINT_TRAJ_PT_FULL_MULTI_H
+#define MOTOMAN_DRIVER_SIMPLE_MESSAGE_JOINT_TRAJ_PT_FULL_MULTI_H
+
+#ifndef FLATHEADERS
+#include "simple_message/byte_array.h"
+#include "simple_message/simple_message.h"
+#include "simple_message/simple_serialize.h"
+#include "simple_message/shared_types.h"
+#else
+#include "byte_array.h"        // NOLINT(build/include)
+#include "simple_message.h"    // NOLINT(build/include)
+#include "simple_serialize.h"  // NOLINT(build/include)
+#include "shared_types.h"      // NOLINT(build/include)
+#endif
+
+namespace industrial
+{
+namespace joint_traj_pt_full_multi
+{
+
+/**
+ * \brief Class encapsulated multiple joint trajectory points, which the controller
+ * processes in order and acknowledges with a single motion reply.  The number of
+ * accepted points is returned in the first data field of the reply.
+ *
+ * Each point has the byte representation of a JointTrajPtFullEx point, but only
+ * holds the groups that are valid for it.  Points are added from the
+ * JointTrajPtFullEx or JointTrajPtFull messages they would otherwise be sent as.
+ *
+ * The message data-packet byte representation is as follows (ordered lowest index
+ * to highest). The standard sizes are given, but can change based on type sizes:
+ *
+ *   member:             type                                      size
+ *   num_points          (industrial::shared_types::shared_int)    4  bytes
+ *   points              JointTrajPtFullEx[]                       num_points * (8 + num_groups * 132) bytes
+ *
+ * THIS CLASS IS NOT THREAD-SAFE
+ *
+ */
+
+class JointTrajPtFullMulti : public industrial::simple_serialize::SimpleSerialize
+{
+public:
+  /**
+   * \brief Default constructor
+   *
+   * This method creates empty data.
+   *
+   */
+  JointTrajPtFullMulti(void);
+  /**
+   * \brief Destructor
+   *
+   */
+  ~JointTrajPtFullMulti(void);
+
+  /**
+   * \brief Initializes an empty set of points
+   *
+   */
+  void init();
+
+  /**
+   * \brief Adds a trajectory point after the ones already added
+   *
+   * \param msg JointTrajPtFullEx or JointTrajPtFull message of the point
+   *
+   * \return true if the point was added, false if it is not a trajectory point or
+   * doesn't fit in the message anymore
+   */
+  bool addPoint(industrial::simple_message::SimpleMessage &msg);
+
+  /**
+   * \brief Returns the number of points
+   *
+   * \return number of points
+   */
+  industrial::shared_types::shared_int getNumPoints()
+  {
+    return this->num_points_;
+  }
+
+  /**
+   * \brief Returns the maximum number of points the controller accepts in a message
+   *
+   * \return maximum number of points
+   */
+  industrial::shared_types::shared_int getMaxPoints()
+  {
+    return MAX_NUM_POINTS;
+  }
+
+  /**
+   * \brief Copies the passed in value
+   *
+   * \param src (value to copy)
+   */
+  void copyFrom(JointTrajPtFullMulti &src);
+
+  /**
+   * \brief == operator implementation
+   *
+   * \return true if equal
+   */
+  bool operator==(JointTrajPtFullMulti &rhs);
+
+  // Overrides - SimpleSerialize
+  bool load(industrial::byte_array::ByteArray *buffer);
+  bool unload(industrial::byte_array::ByteArray *buffer);
+  unsigned int byteLength()
+  {
+    return sizeof(industrial::shared_types::shared_int) + this->points_.getBufferSize();
+  }
+
+private:
+  /**
+   * \brief number of points
+   */
+  industrial::shared_types::shared_int num_points_;
+  /**
+   * \brief byte representation of the points
+   */
+  industrial::byte_array::ByteArray points_;
+
+  /**
+   * \brief maximum number of points, see ROS_MAX_TRAJ_PTS_PER_MSG in MotoROS. As many single
+   * group points (140 bytes) as fit in MAX_POINTS_SIZE.
+   */
+  static const industrial::shared_types::shared_int MAX_NUM_POINTS = 7;
+  /**
+   * \brief maximum byte size of the points. MotoROS can take more, but a simple
+   * message socket doesn't send messages of 1024 bytes or more. A point takes 8 bytes
+   * plus 132 bytes per group, so a single point of 4 groups (536 bytes) fits.
+   */
+  static const industrial::shared_types::shared_int MAX_POINTS_SIZE = 1000;
+};
+}  // namespace joint_traj_pt_full_multi
+}  // namespace industrial
+
+#endif  // MOTOMAN_DRIVER_SIMPLE_MESSAGE_JOINT_TRAJ_PT_FULL_MULTI_H
@@ -63,6 +63,7 @@ enum MotionControlCmd
   STOP_MOTION        = 200111,  // stop robot motion immediately
   START_TRAJ_MODE    = 200121,  // prepare controller to receive ROS motion cmds
   STOP_TRAJ_MODE     = 200122,  // return motion control to INFORM
+  START_SEQUENCE_CHECK = 200131,  // reject trajectory points that are not the next in sequence (for streaming windows)
 };
 }  // namespace MotionControlCmds
 typedef MotionControlCmds::MotionControlCmd MotionControlCmd;
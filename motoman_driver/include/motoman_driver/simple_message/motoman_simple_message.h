@@ -69,6 +69,7 @@ enum MotomanMsgType
   ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX = 2016,  // This is similar to the "Dynamic Joint Point" in REP I0001
   ROS_MSG_MOTO_JOINT_FEEDBACK_EX = 2017,      // Similar to Dynamic Joint State on the REP I0001
   MOTOMAN_SELECT_TOOL = 2018,
+  ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI = 2021,  // Several JointTrajPtFullEx points, acknowledged by one MotionReply
 };
 }  // namespace MotomanMsgTypes
 typedef MotomanMsgTypes::MotomanMsgType MotomanMsgType;
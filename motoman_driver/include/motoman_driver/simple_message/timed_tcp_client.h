@@ -0,0 +1,112 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MOTOMAN_DRIVER_SIMPLE_MESSAGE_TIMED_TCP_CLIENT_H
+#define MOTOMAN_DRIVER_SIMPLE_MESSAGE_TIMED_TCP_CLIENT_H
+
+#include <chrono>
+
+#ifndef FLATHEADERS
+#include "simple_message/simple_message.h"
+#include "simple_message/shared_types.h"
+#include "simple_message/socket/tcp_client.h"
+#else
+#include "simple_message.h"  // NOLINT(build/include)
+#include "shared_types.h"    // NOLINT(build/include)
+#include "tcp_client.h"      // NOLINT(build/include)
+#endif
+
+namespace industrial
+{
+namespace timed_tcp_client
+{
+
+/**
+ * \brief TCP client that gives up on a reply that doesn't arrive within a deadline.
+ *
+ * A plain TcpClient blocks in receiveMsg() for as long as the controller doesn't
+ * answer, and with it everyone waiting to use the connection.  This client waits
+ * at most the reply timeout for the whole of a message to arrive.  When it
+ * expires, the connection is closed, so a late reply can't be mistaken for the
+ * reply to the next request, and the next makeConnect() opens a new one.
+ */
+class TimedTcpClient : public industrial::tcp_client::TcpClient
+{
+public:
+  TimedTcpClient();
+  ~TimedTcpClient();
+
+  /**
+   * \brief Sets the time to wait for a message in receiveMsg()
+   *
+   * \param timeout_ms timeout (ms), <= 0 waits indefinitely
+   */
+  void setReplyTimeout(industrial::shared_types::shared_int timeout_ms)
+  {
+    this->reply_timeout_ms_ = timeout_ms;
+  }
+
+  industrial::shared_types::shared_int getReplyTimeout() const
+  {
+    return this->reply_timeout_ms_;
+  }
+
+  virtual bool receiveMsg(industrial::simple_message::SimpleMessage &message);
+  virtual bool receiveMsg(industrial::simple_message::SimpleMessage &message,
+                          industrial::shared_types::shared_int timeout_ms);
+
+  /**
+   * \brief Closes the connection, the next makeConnect() opens a new one
+   */
+  void disconnect();
+
+private:
+  /**
+   * \brief Waits for a complete message to receive, and closes the connection if it doesn't arrive in time
+   *
+   * \return true if there is a message (or an error that receiving will report)
+   */
+  bool waitForReply();
+
+  /**
+   * \brief Waits until num_bytes can be received, or the deadline
+   *
+   * \return > 0 if they can, 0 at the deadline, < 0 on error
+   */
+  int waitForBytes(int num_bytes, const std::chrono::steady_clock::time_point &deadline);
+
+  industrial::shared_types::shared_int reply_timeout_ms_;
+};
+
+}  // namespace timed_tcp_client
+}  // namespace industrial
+
+#endif  // MOTOMAN_DRIVER_SIMPLE_MESSAGE_TIMED_TCP_CLIENT_H
@@ -0,0 +1,129 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Goal conversion benchmark: times the conversion of large multi-group
+// trajectory goals into DynamicJointTrajectory messages, as done by the
+// joint trajectory action for every goal, and prints the results as JSON.
+//
+// usage: goal_conversion_benchmark [groups] [joints_per_group] [points] [runs]
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <motoman_msgs/DynamicJointTrajectory.h>
+#include <trajectory_msgs/JointTrajectory.h>
+
+#include "motoman_driver/benchmark_samples.h"
+#include "motoman_driver/industrial_robot_client/motoman_utils.h"
+#include "motoman_driver/industrial_robot_client/robot_group.h"
+
+using industrial_robot_client::motoman_utils::toDynamicJointTrajectory;
+using motoman::benchmark::Samples;
+
+namespace
+{
+const int DEFAULT_GROUPS = 4;
+const int DEFAULT_JOINTS_PER_GROUP = 6;
+const int DEFAULT_POINTS = 20000;
+const int DEFAULT_RUNS = 20;
+
+int intArg(int argc, char **argv, int idx, int default_value)
+{
+  if (argc <= idx)
+    return default_value;
+  return std::max(1, std::atoi(argv[idx]));
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const int num_groups = intArg(argc, argv, 1, DEFAULT_GROUPS);
+  const int joints_per_group = intArg(argc, argv, 2, DEFAULT_JOINTS_PER_GROUP);
+  const int num_points = intArg(argc, argv, 3, DEFAULT_POINTS);
+  const int runs = intArg(argc, argv, 4, DEFAULT_RUNS);
+
+  // a goal with all fields for the joints of all groups, like the ones MoveIt sends
+  std::map<int, RobotGroup> robot_groups;
+  trajectory_msgs::JointTrajectory traj;
+  for (int gr = 0; gr < num_groups; ++gr)
+  {
+    std::vector<std::string> joint_names;
+    for (int j = 0; j < joints_per_group; ++j)
+    {
+      std::ostringstream name;
+      name << "group_" << gr + 1 << "_joint_" << j + 1;
+      joint_names.push_back(name.str());
+    }
+    robot_groups[gr].set_group_id(gr);
+    robot_groups[gr].set_joint_names(joint_names);
+    traj.joint_names.insert(traj.joint_names.end(), joint_names.begin(), joint_names.end());
+  }
+
+  const size_t num_joints = traj.joint_names.size();
+  traj.points.resize(num_points);
+  for (int i = 0; i < num_points; ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint &pt = traj.points[i];
+    pt.positions.assign(num_joints, 0.001 * i);
+    pt.velocities.assign(num_joints, 0.1);
+    pt.accelerations.assign(num_joints, 0.0);
+    pt.time_from_start = ros::Duration(0.01 * i);
+  }
+
+  Samples conversion_ms;
+  for (int run = 0; run < runs; ++run)
+  {
+    motoman_msgs::DynamicJointTrajectory dyn_traj;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!toDynamicJointTrajectory(traj, robot_groups, &dyn_traj))
+    {
+      std::cerr << "Conversion failed" << std::endl;
+      return 1;
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    conversion_ms.add(elapsed.count());
+  }
+
+  std::cout << "{\"groups\": " << num_groups
+            << ", \"joints_per_group\": " << joints_per_group
+            << ", \"points\": " << num_points
+            << ", \"conversion_ms\": ";
+  conversion_ms.toJson(std::cout);
+  std::cout << "}" << std::endl;
+  return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "motoman_driver/industrial_robot_client/clock_sync.h"
+#include <algorithm>
+#include <cmath>
+
+namespace industrial_robot_client
+{
+namespace clock_sync
+{
+
+ClockSync::ClockSync(double time_constant, double max_drift, double reset_threshold, double envelope_rise) :
+  time_constant_(time_constant), max_drift_(max_drift), reset_threshold_(reset_threshold),
+  envelope_rise_(envelope_rise), resets_(0)
+{
+  reset();
+}
+
+void ClockSync::reset()
+{
+  initialized_ = false;
+  base_controller_time_ = 0.0;
+  base_receive_time_ = ros::Time();
+  last_x_ = last_y_ = last_sample_y_ = 0.0;
+  mean_x_ = mean_y_ = 0.0;
+  var_x_ = cov_xy_ = 0.0;
+  envelope_ = 0.0;
+  rate_ = 1.0;
+  offset_ = 0.0;
+  latency_ = 0.0;
+}
+
+ros::Time ClockSync::update(double controller_time, const ros::Time &receive_time)
+{
+  double x = controller_time - base_controller_time_;
+  double y = (receive_time - base_receive_time_).toSec();
+
+  if (initialized_ && x == last_x_)
+  {
+    // another packet of the same sample (e.g. another group) gets the same stamp, unless the
+    // controller time has stopped advancing
+    return y - last_y_ <= reset_threshold_ ? base_receive_time_ + ros::Duration(last_sample_y_) : receive_time;
+  }
+
+  // starts over on the first sample, and when the controller time jumps
+  if (!initialized_ || x < last_x_ ||
+      std::fabs(y - (mean_y_ + rate_ * (x - mean_x_) + envelope_)) > reset_threshold_)
+  {
+    if (initialized_)
+      ++resets_;
+    reset();
+    initialized_ = true;
+    base_controller_time_ = controller_time;
+    base_receive_time_ = receive_time;
+    offset_ = receive_time.toSec() - controller_time;
+    return receive_time;
+  }
+
+  // exponentially weighted update, older samples count less the more controller time has passed
+  const double dt = x - last_x_;
+  const double alpha = 1.0 - std::exp(-dt / time_constant_);
+  const double dx = x - mean_x_;
+  const double dy = y - mean_y_;
+  mean_x_ += alpha * dx;
+  mean_y_ += alpha * dy;
+  var_x_ = (1.0 - alpha) * (var_x_ + alpha * dx * dx);
+  cov_xy_ = (1.0 - alpha) * (cov_xy_ + alpha * dx * dy);
+  last_x_ = x;
+  last_y_ = y;
+
+  // the rate is noisy until the samples span some time, clocks don't drift apart that fast
+  rate_ = var_x_ > 0.0 ? cov_xy_ / var_x_ : 1.0;
+  rate_ = std::max(1.0 - max_drift_, std::min(1.0 + max_drift_, rate_));
+
+  // shifts the fit down to the fastest recent samples
+  const double fit = mean_y_ + rate_ * (x - mean_x_);
+  envelope_ = std::min(y - fit, envelope_ + envelope_rise_ * dt);
+  const double sample_y = fit + envelope_;
+
+  last_sample_y_ = sample_y;
+  latency_ = y - sample_y;
+  offset_ = (base_receive_time_.toSec() + sample_y) - controller_time;
+  return base_receive_time_ + ros::Duration(sample_y);
+}
+
+}  // namespace clock_sync
+}  // namespace industrial_robot_client
@@ -0,0 +1,285 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "motoman_driver/industrial_robot_client/goal_monitor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace industrial_robot_client
+{
+namespace joint_trajectory_action
+{
+
+// Resolves a tolerance of control_msgs/JointTolerance (0: default, < 0: none) to a limit,
+// infinity if the joint isn't checked
+static double resolveTolerance(double tolerance, double default_tolerance)
+{
+  if (tolerance == 0.0)
+    tolerance = default_tolerance;
+  return tolerance > 0.0 ? tolerance : std::numeric_limits<double>::infinity();
+}
+
+// Applies the tolerances of a goal to the joints they name, other joints keep their defaults
+static void applyTolerances(const std::vector<control_msgs::JointTolerance> &tolerances,
+                            const std::vector<std::string> &joint_names,
+                            const std::vector<double> &default_position, std::vector<double> *position,
+                            std::vector<double> *velocity)
+{
+  for (size_t i = 0; i < tolerances.size(); ++i)
+  {
+    std::vector<std::string>::const_iterator it =
+      std::find(joint_names.begin(), joint_names.end(), tolerances[i].name);
+    if (it == joint_names.end())
+      continue;
+    const size_t j = it - joint_names.begin();
+    (*position)[j] = resolveTolerance(tolerances[i].position, j < default_position.size() ? default_position[j] : 0.0);
+    if (velocity)
+      (*velocity)[j] = resolveTolerance(tolerances[i].velocity, 0.0);
+  }
+}
+
+// Reorders each row of values, indices[j] is the old column of new column j
+static void reorderRows(const std::vector<size_t> &indices, std::vector<double> *values)
+{
+  const size_t num_columns = indices.size();
+  std::vector<double> reordered(values->size());
+  for (size_t row = 0; row < values->size(); row += num_columns)
+    for (size_t j = 0; j < num_columns; ++j)
+      reordered[row + j] = (*values)[row + indices[j]];
+  values->swap(reordered);
+}
+
+const double GoalMonitor::MOTION_THRESHOLD = 1e-3;
+
+GoalMonitor::GoalMonitor() :
+  goal_time_tolerance_(std::numeric_limits<double>::infinity()), motion_start_(0.0), started_(false),
+  next_point_(0), within_goal_(false), trajectory_ended_(false), goal_time_exceeded_(false), path_violation_(-1)
+{
+}
+
+bool GoalMonitor::init(const control_msgs::FollowJointTrajectoryGoal &goal, const std::vector<std::string> &joint_names,
+                       const ros::Time &accepted, const std::vector<double> &path_tolerance,
+                       const std::vector<double> &goal_tolerance, double goal_time_tolerance)
+{
+  clear();
+
+  const trajectory_msgs::JointTrajectory &traj = goal.trajectory;
+  const size_t num_joints = joint_names.size();
+  if (traj.points.empty() || num_joints == 0)
+    return false;
+
+  std::vector<size_t> indices(num_joints);
+  for (size_t j = 0; j < num_joints; ++j)
+  {
+    std::vector<std::string>::const_iterator it =
+      std::find(traj.joint_names.begin(), traj.joint_names.end(), joint_names[j]);
+    if (it == traj.joint_names.end())
+      return false;
+    indices[j] = it - traj.joint_names.begin();
+  }
+
+  positions_.resize(traj.points.size() * num_joints);
+  times_.resize(traj.points.size());
+  for (size_t p = 0; p < traj.points.size(); ++p)
+  {
+    const trajectory_msgs::JointTrajectoryPoint &pt = traj.points[p];
+    if (pt.positions.size() < traj.joint_names.size())
+    {
+      clear();
+      return false;
+    }
+    for (size_t j = 0; j < num_joints; ++j)
+      positions_[p * num_joints + j] = pt.positions[indices[j]];
+    times_[p] = pt.time_from_start.toSec();
+  }
+
+  path_tolerance_.resize(num_joints);
+  goal_tolerance_.resize(num_joints);
+  goal_velocity_tolerance_.assign(num_joints, std::numeric_limits<double>::infinity());
+  for (size_t j = 0; j < num_joints; ++j)
+  {
+    path_tolerance_[j] = resolveTolerance(0.0, j < path_tolerance.size() ? path_tolerance[j] : 0.0);
+    goal_tolerance_[j] = resolveTolerance(0.0, j < goal_tolerance.size() ? goal_tolerance[j] : 0.0);
+  }
+  applyTolerances(goal.path_tolerance, joint_names, path_tolerance, &path_tolerance_, NULL);
+  applyTolerances(goal.goal_tolerance, joint_names, goal_tolerance, &goal_tolerance_, &goal_velocity_tolerance_);
+  goal_time_tolerance_ = resolveTolerance(goal.goal_time_tolerance.toSec(), goal_time_tolerance);
+
+  // the robot holds its position until the trajectory leaves its first position
+  size_t first_move = 1;
+  while (first_move < times_.size() &&
+         std::equal(positions_.begin() + first_move * num_joints, positions_.begin() + (first_move + 1) * num_joints,
+                    positions_.begin()))
+    ++first_move;
+  motion_start_ = times_[first_move - 1];
+
+  joint_names_ = joint_names;
+  accepted_ = accepted;
+  start_ = accepted;
+  return true;
+}
+
+void GoalMonitor::clear()
+{
+  joint_names_.clear();
+  positions_.clear();
+  times_.clear();
+  path_tolerance_.clear();
+  goal_tolerance_.clear();
+  goal_velocity_tolerance_.clear();
+  goal_time_tolerance_ = std::numeric_limits<double>::infinity();
+  motion_start_ = 0.0;
+  hold_positions_.clear();
+  started_ = false;
+  next_point_ = 0;
+  within_goal_ = false;
+  trajectory_ended_ = false;
+  goal_time_exceeded_ = false;
+  path_violation_ = -1;
+}
+
+bool GoalMonitor::reorder(const std::vector<std::string> &names)
+{
+  const size_t num_joints = joint_names_.size();
+  if (names.size() != num_joints)
+    return false;
+
+  std::vector<size_t> indices(num_joints);
+  for (size_t j = 0; j < num_joints; ++j)
+  {
+    std::vector<std::string>::const_iterator it = std::find(joint_names_.begin(), joint_names_.end(), names[j]);
+    if (it == joint_names_.end())
+      return false;
+    indices[j] = it - joint_names_.begin();
+  }
+
+  reorderRows(indices, &positions_);
+  reorderRows(indices, &path_tolerance_);
+  reorderRows(indices, &goal_tolerance_);
+  reorderRows(indices, &goal_velocity_tolerance_);
+  if (!hold_positions_.empty())
+    reorderRows(indices, &hold_positions_);
+  joint_names_ = names;
+  return true;
+}
+
+bool GoalMonitor::update(const control_msgs::FollowJointTrajectoryFeedback &state,
+                         control_msgs::FollowJointTrajectoryFeedback *feedback)
+{
+  if (empty())
+    return false;
+
+  // the feedback is normally in the order of the robot group, so this reorders at most once per goal
+  if (state.joint_names != joint_names_ && !reorder(state.joint_names))
+    return false;
+
+  const size_t num_joints = joint_names_.size();
+  if (state.actual.positions.size() < num_joints)
+    return false;
+
+  // anchors the trajectory at the first feedback the robot has moved in, the time it left the first position
+  const ros::Time stamp = state.header.stamp.isZero() ? ros::Time::now() : state.header.stamp;
+  if (!started_)
+  {
+    if (hold_positions_.empty())
+      hold_positions_.assign(state.actual.positions.begin(), state.actual.positions.begin() + num_joints);
+    for (size_t j = 0; j < num_joints && !started_; ++j)
+      started_ = std::fabs(state.actual.positions[j] - hold_positions_[j]) > MOTION_THRESHOLD;
+    if (started_)
+      start_ = stamp - ros::Duration(motion_start_);
+    else if ((stamp - accepted_).toSec() >= times_.back())
+      started_ = true;
+  }
+
+  // finds the segment of the trajectory at the time of the feedback, starting from the last one
+  const double t = started_ ? (stamp - start_).toSec() : 0.0;
+  while (next_point_ < times_.size() && times_[next_point_] < t)
+    ++next_point_;
+  while (next_point_ > 0 && times_[next_point_ - 1] >= t)
+    --next_point_;
+
+  const double *from;
+  const double *to;
+  double alpha = 0.0;
+  if (next_point_ == 0)
+  {
+    from = to = &positions_[0];
+  }
+  else if (next_point_ == times_.size())
+  {
+    from = to = &positions_[(times_.size() - 1) * num_joints];
+  }
+  else
+  {
+    from = &positions_[(next_point_ - 1) * num_joints];
+    to = &positions_[next_point_ * num_joints];
+    alpha = (t - times_[next_point_ - 1]) / (times_[next_point_] - times_[next_point_ - 1]);
+  }
+
+  feedback->header = state.header;
+  if (feedback->joint_names != joint_names_)
+    feedback->joint_names = joint_names_;
+  feedback->actual = state.actual;
+  feedback->desired.positions.resize(num_joints);
+  feedback->desired.time_from_start = ros::Duration(std::max(t, 0.0));
+  feedback->error.positions.resize(num_joints);
+  feedback->error.time_from_start = feedback->desired.time_from_start;
+
+  trajectory_ended_ = started_ && t >= times_.back();
+  goal_time_exceeded_ = started_ && t > times_.back() + goal_time_tolerance_;
+  within_goal_ = true;
+  path_violation_ = -1;
+
+  // velocities are only checked if the controller reports them
+  const double *actual = &state.actual.positions[0];
+  const double *velocity = state.actual.velocities.size() >= num_joints ? &state.actual.velocities[0] : NULL;
+  const double *goal = &positions_[(times_.size() - 1) * num_joints];
+  double *desired = &feedback->desired.positions[0];
+  double *error = &feedback->error.positions[0];
+  for (size_t j = 0; j < num_joints; ++j)
+  {
+    desired[j] = from[j] + alpha * (to[j] - from[j]);
+    error[j] = desired[j] - actual[j];
+    if (std::fabs(actual[j] - goal[j]) > goal_tolerance_[j] ||
+        (velocity && std::fabs(velocity[j]) > goal_velocity_tolerance_[j]))
+      within_goal_ = false;
+    if (path_violation_ < 0 && started_ && !trajectory_ended_ && std::fabs(error[j]) > path_tolerance_[j])
+      path_violation_ = j;
+  }
+
+  return true;
+}
+
+}  // namespace joint_trajectory_action
+}  // namespace industrial_robot_client
@@ -82,6 +82,19 @@ bool JointFeedbackExRelayHandler::init(SmplMsgConnection* connection,
 }
 
 
+// Returns msg, ready to be filled again.  A message that a subscriber in this process still
+// holds (roscpp passes published pointers on as they are) is copied first, which keeps its
+// buffers and names for the new one.
+template <typename M>
+static const boost::shared_ptr<M>& reuse(boost::shared_ptr<M>* msg)
+{
+  if (!*msg)
+    msg->reset(new M());
+  else if (!msg->unique())
+    msg->reset(new M(**msg));
+  return *msg;
+}
+
 bool JointFeedbackExRelayHandler::create_messages(SimpleMessage& msg_in,
     control_msgs::FollowJointTrajectoryFeedback* control_state,
     sensor_msgs::JointState* sensor_state)
@@ -89,78 +102,82 @@ bool JointFeedbackExRelayHandler::create_messages(SimpleMessage& msg_in,
   // inspect groups_number field first, to avoid "Failed to Convert" message
   JointFeedbackExMessage tmp_msg;
   tmp_msg.init(msg_in);
-  motoman_msgs::DynamicJointTrajectoryFeedback dynamic_control_state;
 
-  for (size_t i = 0; i < tmp_msg.getJointMessages().size(); i++)
+  std::vector<JointFeedbackMessage> joint_msgs = tmp_msg.getJointMessages();
+
+  // one timestamp for all messages of this controller packet, the controller time of its samples
+  shared_real controller_time = 0;
+  const bool has_time = !joint_msgs.empty() && joint_msgs[0].getTime(controller_time);
+  const ros::Time stamp = stamp_packet(has_time, controller_time);
+
+  const motoman_msgs::DynamicJointTrajectoryFeedbackPtr& dynamic_control_state = reuse(&dynamic_control_state_);
+  dynamic_control_state->joint_feedbacks.resize(joint_msgs.size());
+
+  for (size_t i = 0; i < joint_msgs.size(); i++)
   {
-    int group_number = tmp_msg.getJointMessages()[i].getRobotID();
+    int group_number = joint_msgs[i].getRobotID();
 
-    if (!create_messages(tmp_msg.getJointMessages()[i], control_state, sensor_state, group_number))
+    if (!create_messages(joint_msgs[i], stamp, group_number, &dynamic_control_state->joint_feedbacks[i]))
     {
       return false;
     }
-    motoman_msgs::DynamicJointState dyn_joint_state;
-    dyn_joint_state.num_joints = control_state->joint_names.size();
-    dyn_joint_state.group_number = group_number;
-    dyn_joint_state.valid_fields = this->valid_fields_from_message_;
-    dyn_joint_state.positions = control_state->actual.positions;
-    dyn_joint_state.velocities = control_state->actual.velocities;
-    dyn_joint_state.accelerations = control_state->actual.accelerations;
-    dynamic_control_state.joint_feedbacks.push_back(dyn_joint_state);
   }
-  dynamic_control_state.header.stamp = ros::Time::now();
-  dynamic_control_state.num_groups = tmp_msg.getGroupsNumber();
+  dynamic_control_state->header.stamp = stamp;
+  dynamic_control_state->num_groups = tmp_msg.getGroupsNumber();
   this->dynamic_pub_joint_control_state_.publish(dynamic_control_state);
 
   return true;
 }
 
-bool JointFeedbackExRelayHandler::create_messages(JointFeedbackMessage& msg_in,
-    control_msgs::FollowJointTrajectoryFeedback* control_state,
-    sensor_msgs::JointState* sensor_state, int robot_id)
+bool JointFeedbackExRelayHandler::create_messages(JointFeedbackMessage& msg_in, const ros::Time& stamp,
+    int robot_id, motoman_msgs::DynamicJointState* dyn_joint_state)
 {
-  DynamicJointsGroup all_joint_state;
-  if (!JointFeedbackExRelayHandler::convert_message(msg_in, &all_joint_state, robot_id))
+  if (!JointFeedbackExRelayHandler::convert_message(msg_in, &all_joint_state_, robot_id))
   {
     LOG_ERROR("Failed to convert SimpleMessage");
     return false;
   }
   // apply transform, if required
-  DynamicJointsGroup xform_joint_state;
-  if (!transform(all_joint_state, &xform_joint_state))
+  if (!transform(all_joint_state_, &xform_joint_state_))
   {
     LOG_ERROR("Failed to transform joint state");
     return false;
   }
 
   // select specific joints for publishing
-  DynamicJointsGroup pub_joint_state;
-  std::vector<std::string> pub_joint_names;
-  if (!select(xform_joint_state, robot_groups_[robot_id].get_joint_names(), &pub_joint_state, &pub_joint_names))
+  if (!select(xform_joint_state_, robot_groups_[robot_id].get_joint_names(), &pub_joint_state_, &pub_joint_names_))
   {
     LOG_ERROR("Failed to select joints for publishing");
     return false;
   }
 
+  // assign values to messages, the names normally only once per group
+  const control_msgs::FollowJointTrajectoryFeedbackPtr& control_state = reuse(&control_states_[robot_id]);
+  control_state->header.stamp = stamp;
+  if (control_state->joint_names != pub_joint_names_)
+    control_state->joint_names = pub_joint_names_;
+  control_state->actual.positions = pub_joint_state_.positions;
+  control_state->actual.velocities = pub_joint_state_.velocities;
+  control_state->actual.accelerations = pub_joint_state_.accelerations;
+  control_state->actual.time_from_start = pub_joint_state_.time_from_start;
 
-  // assign values to messages
-  *control_state = control_msgs::FollowJointTrajectoryFeedback();  // always start with a "clean" message
-  control_state->header.stamp = ros::Time::now();
-  control_state->joint_names = pub_joint_names;
-  control_state->actual.positions = pub_joint_state.positions;
-  control_state->actual.velocities = pub_joint_state.velocities;
-  control_state->actual.accelerations = pub_joint_state.accelerations;
-  control_state->actual.time_from_start = pub_joint_state.time_from_start;
+  this->pub_joint_control_state_.publish(control_state);
 
-  this->pub_joint_control_state_.publish(*control_state);
+  const sensor_msgs::JointStatePtr& sensor_state = reuse(&sensor_states_[robot_id]);
+  sensor_state->header.stamp = stamp;
+  if (sensor_state->name != pub_joint_names_)
+    sensor_state->name = pub_joint_names_;
+  sensor_state->position = pub_joint_state_.positions;
+  sensor_state->velocity = pub_joint_state_.velocities;
 
-  *sensor_state = sensor_msgs::JointState();  // always start with a "clean" message
-  sensor_state->header.stamp = ros::Time::now();
-  sensor_state->name = pub_joint_names;
-  sensor_state->position = pub_joint_state.positions;
-  sensor_state->velocity = pub_joint_state.velocities;
+  this->pub_joint_sensor_state_.publish(sensor_state);
 
-  this->pub_joint_sensor_state_.publish(*sensor_state);
+  dyn_joint_state->num_joints = pub_joint_names_.size();
+  dyn_joint_state->group_number = robot_id;
+  dyn_joint_state->valid_fields = this->valid_fields_from_message_;
+  dyn_joint_state->positions = pub_joint_state_.positions;
+  dyn_joint_state->velocities = pub_joint_state_.velocities;
+  dyn_joint_state->accelerations = pub_joint_state_.accelerations;
 
   return true;
 }
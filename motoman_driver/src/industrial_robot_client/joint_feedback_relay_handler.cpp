@@ -111,9 +111,16 @@ bool JointFeedbackRelayHandler::create_messages(SimpleMessage& msg_in,
     LOG_ERROR("Failed to select joints for publishing");
     return false;
   }
+  // stamp with the controller time of the sample, if its time field is valid
+  JointFeedbackMessage joint_msg;
+  joint_msg.init(msg_in);
+  shared_real controller_time = 0;
+  const bool has_time = joint_msg.getTime(controller_time);
+  const ros::Time stamp = stamp_packet(has_time, controller_time);
+
   // assign values to messages
   *control_state = control_msgs::FollowJointTrajectoryFeedback();  // always start with a "clean" message
-  control_state->header.stamp = ros::Time::now();
+  control_state->header.stamp = stamp;
   control_state->joint_names = pub_joint_names;
   control_state->actual.positions = pub_joint_state.positions;
   control_state->actual.velocities = pub_joint_state.velocities;
@@ -121,7 +128,7 @@ bool JointFeedbackRelayHandler::create_messages(SimpleMessage& msg_in,
   control_state->actual.time_from_start = pub_joint_state.time_from_start;
 
   *sensor_state = sensor_msgs::JointState();  // always start with a "clean" message
-  sensor_state->header.stamp = ros::Time::now();
+  sensor_state->header.stamp = stamp;
   sensor_state->name = pub_joint_names;
   sensor_state->position = pub_joint_state.positions;
   sensor_state->velocity = pub_joint_state.velocities;
@@ -48,6 +48,8 @@ namespace industrial_robot_client
 namespace joint_relay_handler
 {
 
+const double JointRelayHandler::CONTROLLER_TIME_PERIOD = 1048.576;
+
 bool JointRelayHandler::init(SmplMsgConnection* connection, int msg_type, std::map<int, RobotGroup> &robot_groups)
 {
   this->robot_groups_ = robot_groups;
@@ -68,8 +70,7 @@ bool JointRelayHandler::init(SmplMsgConnection* connection, int msg_type, std::m
     this->pub_states_[robot_id] = this->pub_joint_sensor_state_;
   }
 
-
-
+  this->pub_diagnostics_ = this->node_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
 
   return MessageHandler::init(msg_type, connection);
 }
@@ -84,9 +85,55 @@ bool JointRelayHandler::init(SmplMsgConnection* connection, int msg_type, std::v
   // save "complete" joint-name list, preserving any blank entries for later use
   this->all_joint_names_ = joint_names;
 
+  this->pub_diagnostics_ = this->node_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+
   return MessageHandler::init(msg_type, connection);
 }
 
+ros::Time JointRelayHandler::stamp_packet(bool has_time, double controller_time)
+{
+  const ros::Time now = ros::Time::now();
+  if (!has_time)
+    return now;
+
+  // a large step back is the controller time wrapping around, not a restart of the controller
+  if (controller_time < last_controller_time_ - CONTROLLER_TIME_PERIOD / 2)
+    controller_time_base_ += CONTROLLER_TIME_PERIOD;
+  last_controller_time_ = controller_time;
+
+  const ros::Time stamp = clock_sync_.update(controller_time_base_ + controller_time, now);
+
+  if ((now - last_diagnostics_).toSec() >= 1.0)
+  {
+    last_diagnostics_ = now;
+
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = ros::this_node::getName() + ": controller clock";
+    status.message = "Feedback stamped with controller time";
+    diagnostic_msgs::KeyValue value;
+    value.key = "Offset (s)";
+    value.value = std::to_string(clock_sync_.getOffset());
+    status.values.push_back(value);
+    value.key = "Drift (ppm)";
+    value.value = std::to_string(clock_sync_.getDrift() * 1e6);
+    status.values.push_back(value);
+    value.key = "Latency (ms)";
+    value.value = std::to_string(clock_sync_.getLatency() * 1e3);
+    status.values.push_back(value);
+    value.key = "Resets";
+    value.value = std::to_string(clock_sync_.getResets());
+    status.values.push_back(value);
+
+    diagnostic_msgs::DiagnosticArray diagnostics;
+    diagnostics.header.stamp = now;
+    diagnostics.status.push_back(status);
+    pub_diagnostics_.publish(diagnostics);
+  }
+
+  return stamp;
+}
+
 /*! This is responsible for publishing the generated messages */
 
 bool JointRelayHandler::internalCB(SimpleMessage& msg_in)
@@ -321,15 +368,22 @@ bool JointRelayHandler::select(const DynamicJointsGroup& all_joint_state,
 {
   ROS_ASSERT(all_joint_state.positions.size() == all_joint_names.size());
 
-  *pub_joint_state = DynamicJointsGroup();  // start with a "clean" message
-  pub_joint_names->clear();
+  // start with a "clean" message, but keep the buffers, so callers can reuse pub_joint_state and
+  // pub_joint_names without allocating
+  pub_joint_state->positions.clear();
+  pub_joint_state->velocities.clear();
+  pub_joint_state->accelerations.clear();
+  pub_joint_state->effort.clear();
+  size_t num_pub_joints = 0;
 
   // skip over "blank" joint names
   for (size_t i = 0; i < all_joint_names.size(); ++i)
   {
     if (all_joint_names[i].empty())
       continue;
-    pub_joint_names->push_back(all_joint_names[i]);
+    if (pub_joint_names->size() <= num_pub_joints)
+      pub_joint_names->resize(num_pub_joints + 1);
+    (*pub_joint_names)[num_pub_joints++] = all_joint_names[i];
     if (!all_joint_state.positions.empty())
       pub_joint_state->positions.push_back(all_joint_state.positions[i]);
     if (!all_joint_state.velocities.empty())
@@ -337,6 +391,7 @@ bool JointRelayHandler::select(const DynamicJointsGroup& all_joint_state,
     if (!all_joint_state.accelerations.empty())
       pub_joint_state->accelerations.push_back(all_joint_state.accelerations[i]);
   }
+  pub_joint_names->resize(num_pub_joints);
   pub_joint_state->time_from_start = all_joint_state.time_from_start;
 
   return true;
@@ -36,11 +36,13 @@
 #include <industrial_robot_client/utils.h>
 #include <industrial_utils/param_utils.h>
 #include <industrial_utils/utils.h>
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
 
 using industrial_robot_client::motoman_utils::getJointGroups;
+using industrial_robot_client::motoman_utils::toDynamicJointTrajectory;
 
 namespace industrial_robot_client
 {
@@ -58,6 +60,7 @@ JointTrajectoryAction::JointTrajectoryAction() :
   ros::NodeHandle pn("~");
 
   pn.param("constraints/goal_threshold", goal_threshold_, DEFAULT_GOAL_THRESHOLD_);
+  pn.param("constraints/goal_time", goal_time_tolerance_, 0.0);
 
   std::map<int, RobotGroup> robot_groups;
   if (!getJointGroups("topic_list", robot_groups))
@@ -78,6 +81,15 @@ JointTrajectoryAction::JointTrajectoryAction() :
 
     all_joint_names_.insert(all_joint_names_.end(), rg_joint_names.begin(), rg_joint_names.end());
 
+    for (size_t j = 0; j < rg_joint_names.size(); j++)
+    {
+      double goal_tolerance, path_tolerance;
+      pn.param("constraints/" + rg_joint_names[j] + "/goal", goal_tolerance, goal_threshold_);
+      pn.param("constraints/" + rg_joint_names[j] + "/trajectory", path_tolerance, 0.0);
+      goal_tolerance_map_[group_number_int].push_back(goal_tolerance);
+      path_tolerance_map_[group_number_int].push_back(path_tolerance);
+    }
+
     actionServer_ = new actionlib::ActionServer<control_msgs::FollowJointTrajectoryAction>(
       node_, joint_path_action_name + "/joint_trajectory_action" , false);
     actionServer_->registerGoalCallback(
@@ -198,115 +210,24 @@ void JointTrajectoryAction::watchdog(const ros::TimerEvent &e, int group_number)
 
 void JointTrajectoryAction::goalCB(JointTractoryActionServer::GoalHandle gh)
 {
-  gh.setAccepted();
-
-  int group_number;
-
-// TODO(thiagodefreitas): change for getting the id from the group instead of a sequential checking on the map
+  const control_msgs::FollowJointTrajectoryGoalConstPtr goal = gh.getGoal();
 
-  ros::Duration last_time_from_start(0.0);
-
-  motoman_msgs::DynamicJointTrajectory dyn_traj;
-
-  for (size_t i = 0; i < gh.getGoal()->trajectory.points.size(); i++)
+  // published as a pointer, so a streamer in the same process gets it without a copy
+  motoman_msgs::DynamicJointTrajectoryPtr dyn_traj(new motoman_msgs::DynamicJointTrajectory);
+  if (!toDynamicJointTrajectory(goal->trajectory, robot_groups_, dyn_traj.get()))
   {
-    motoman_msgs::DynamicJointPoint dpoint;
-
-    for (size_t rbt_idx = 0; rbt_idx < robot_groups_.size(); rbt_idx++)
-    {
-      size_t ros_idx = std::find(
-                         gh.getGoal()->trajectory.joint_names.begin(),
-                         gh.getGoal()->trajectory.joint_names.end(),
-                         robot_groups_[rbt_idx].get_joint_names()[0])
-                       - gh.getGoal()->trajectory.joint_names.begin();
-
-      bool is_found = ros_idx < gh.getGoal()->trajectory.joint_names.size();
-
-      group_number = rbt_idx;
-      motoman_msgs::DynamicJointsGroup dyn_group;
-
-      int num_joints = robot_groups_[group_number].get_joint_names().size();
-
-      if (is_found)
-      {
-        if (gh.getGoal()->trajectory.points[i].positions.empty())
-        {
-          std::vector<double> positions(num_joints, 0.0);
-          dyn_group.positions = positions;
-        }
-        else
-          dyn_group.positions.insert(
-            dyn_group.positions.begin(),
-            gh.getGoal()->trajectory.points[i].positions.begin() + ros_idx,
-            gh.getGoal()->trajectory.points[i].positions.begin() + ros_idx
-            + robot_groups_[rbt_idx].get_joint_names().size());
-
-        if (gh.getGoal()->trajectory.points[i].velocities.empty())
-        {
-          std::vector<double> velocities(num_joints, 0.0);
-          dyn_group.velocities = velocities;
-        }
-        else
-          dyn_group.velocities.insert(
-            dyn_group.velocities.begin(),
-            gh.getGoal()->trajectory.points[i].velocities.begin()
-            + ros_idx, gh.getGoal()->trajectory.points[i].velocities.begin()
-            + ros_idx + robot_groups_[rbt_idx].get_joint_names().size());
-
-        if (gh.getGoal()->trajectory.points[i].accelerations.empty())
-        {
-          std::vector<double> accelerations(num_joints, 0.0);
-          dyn_group.accelerations = accelerations;
-        }
-        else
-          dyn_group.accelerations.insert(
-            dyn_group.accelerations.begin(),
-            gh.getGoal()->trajectory.points[i].accelerations.begin()
-            + ros_idx, gh.getGoal()->trajectory.points[i].accelerations.begin()
-            + ros_idx + robot_groups_[rbt_idx].get_joint_names().size());
-        if (gh.getGoal()->trajectory.points[i].effort.empty())
-        {
-          std::vector<double> effort(num_joints, 0.0);
-          dyn_group.effort = effort;
-        }
-        else
-          dyn_group.effort.insert(
-            dyn_group.effort.begin(),
-            gh.getGoal()->trajectory.points[i].effort.begin()
-            + ros_idx, gh.getGoal()->trajectory.points[i].effort.begin()
-            + ros_idx + robot_groups_[rbt_idx].get_joint_names().size());
-        dyn_group.time_from_start = gh.getGoal()->trajectory.points[i].time_from_start;
-        dyn_group.group_number = group_number;
-        dyn_group.num_joints = dyn_group.positions.size();
-      }
-
-      // Generating message for groups that were not present in the trajectory message
-      else
-      {
-        std::vector<double> positions(num_joints, 0.0);
-        std::vector<double> velocities(num_joints, 0.0);
-        std::vector<double> accelerations(num_joints, 0.0);
-        std::vector<double> effort(num_joints, 0.0);
-
-        dyn_group.positions = positions;
-        dyn_group.velocities = velocities;
-        dyn_group.accelerations = accelerations;
-        dyn_group.effort = effort;
-
-        dyn_group.time_from_start = gh.getGoal()->trajectory.points[i].time_from_start;
-        dyn_group.group_number = group_number;
-        dyn_group.num_joints = num_joints;
-      }
-
-      dpoint.groups.push_back(dyn_group);
-    }
-    dpoint.num_groups = dpoint.groups.size();
-    dyn_traj.points.push_back(dpoint);
+    ROS_ERROR("Joint trajectory action failing on invalid joints");
+    control_msgs::FollowJointTrajectoryResult rslt;
+    rslt.error_code = control_msgs::FollowJointTrajectoryResult::INVALID_JOINTS;
+    gh.setRejected(rslt, "Joint names do not match the robot groups");
+    return;
   }
-  dyn_traj.header = gh.getGoal()->trajectory.header;
-  dyn_traj.header.stamp = ros::Time::now();
+  gh.setAccepted();
+
+  dyn_traj->header = goal->trajectory.header;
+  dyn_traj->header.stamp = ros::Time::now();
   // Publishing the joint names for the 4 groups
-  dyn_traj.joint_names = all_joint_names_;
+  dyn_traj->joint_names = all_joint_names_;
 
   this->pub_trajectory_command_.publish(dyn_traj);
 }
@@ -327,17 +248,41 @@ void JointTrajectoryAction::goalCB(JointTractoryActionServer::GoalHandle gh, int
           this->robot_groups_[group_number].get_joint_names(),
           gh.getGoal()->trajectory.joint_names))
     {
-      // Cancels the currently active goal.
+      // Prepares the monitor of the goal first, so an invalid goal leaves the active goal alone
+      const trajectory_msgs::JointTrajectory &traj = gh.getGoal()->trajectory;
+      GoalMonitor monitor;
+      if (!monitor.init(*gh.getGoal(), robot_groups_[group_number].get_joint_names(), ros::Time::now(),
+                        path_tolerance_map_[group_number], goal_tolerance_map_[group_number], goal_time_tolerance_))
+      {
+        ROS_ERROR("Joint trajectory action failing on invalid trajectory");
+        control_msgs::FollowJointTrajectoryResult rslt;
+        rslt.error_code = control_msgs::FollowJointTrajectoryResult::INVALID_GOAL;
+        gh.setRejected(rslt, "Trajectory points have fewer positions than joints");
+        return;
+      }
+
+      // Cancels the currently active goal. The motion isn't stopped here, the streamer splices the new
+      // trajectory into the current one if it continues from it, and stops the robot otherwise.
+      bool preempted = false;
       if (has_active_goal_map_[group_number])
       {
         ROS_WARN("Received new goal, canceling current goal");
-        abortGoal(group_number);
+        active_goal_map_[group_number].setAborted();
+        has_active_goal_map_[group_number] = false;
+        preempted = true;
       }
       // Sends the trajectory along to the controller
-      if (withinGoalConstraints(last_trajectory_state_map_[group_number],
-                                gh.getGoal()->trajectory, group_number))
+      control_msgs::FollowJointTrajectoryFeedback feedback;
+      if (last_trajectory_state_map_[group_number] &&
+          monitor.update(*last_trajectory_state_map_[group_number], &feedback) && monitor.withinGoal())
       {
         ROS_INFO_STREAM("Already within goal constraints, setting goal succeeded");
+        if (preempted)
+        {
+          // Stops the controller, nothing replaces the motion of the canceled goal
+          motoman_msgs::DynamicJointTrajectory empty;
+          pub_trajectories_[group_number].publish(empty);
+        }
         gh.setAccepted();
         gh.setSucceeded();
         has_active_goal_map_[group_number] = false;
@@ -347,59 +292,25 @@ void JointTrajectoryAction::goalCB(JointTractoryActionServer::GoalHandle gh, int
         gh.setAccepted();
         active_goal_map_[group_number] = gh;
         has_active_goal_map_[group_number]  = true;
+        goal_monitor_map_[group_number] = monitor;
 
         ROS_INFO("Publishing trajectory");
 
-        current_traj_map_[group_number] = active_goal_map_[group_number].getGoal()->trajectory;
-
-        int num_joints = robot_groups_[group_number].get_joint_names().size();
+        current_traj_map_[group_number] = traj;
 
-        motoman_msgs::DynamicJointTrajectory dyn_traj;
-
-        for (size_t i = 0; i < current_traj_map_[group_number].points.size(); ++i)
+        // published as a pointer, so a streamer in the same process gets it without a copy
+        std::map<int, RobotGroup> group;
+        group[group_number] = robot_groups_[group_number];
+        motoman_msgs::DynamicJointTrajectoryPtr dyn_traj(new motoman_msgs::DynamicJointTrajectory);
+        if (!toDynamicJointTrajectory(traj, group, dyn_traj.get()))
         {
-          motoman_msgs::DynamicJointsGroup dyn_group;
-          motoman_msgs::DynamicJointPoint dyn_point;
-
-          if (gh.getGoal()->trajectory.points[i].positions.empty())
-          {
-            std::vector<double> positions(num_joints, 0.0);
-            dyn_group.positions = positions;
-          }
-          else
-            dyn_group.positions = gh.getGoal()->trajectory.points[i].positions;
-
-          if (gh.getGoal()->trajectory.points[i].velocities.empty())
-          {
-            std::vector<double> velocities(num_joints, 0.0);
-            dyn_group.velocities = velocities;
-          }
-          else
-            dyn_group.velocities = gh.getGoal()->trajectory.points[i].velocities;
-          if (gh.getGoal()->trajectory.points[i].accelerations.empty())
-          {
-            std::vector<double> accelerations(num_joints, 0.0);
-            dyn_group.accelerations = accelerations;
-          }
-          else
-            dyn_group.accelerations = gh.getGoal()->trajectory.points[i].accelerations;
-          if (gh.getGoal()->trajectory.points[i].effort.empty())
-          {
-            std::vector<double> effort(num_joints, 0.0);
-            dyn_group.effort = effort;
-          }
-          else
-            dyn_group.effort = gh.getGoal()->trajectory.points[i].effort;
-          dyn_group.time_from_start = gh.getGoal()->trajectory.points[i].time_from_start;
-          dyn_group.group_number = group_number;
-          dyn_group.num_joints = robot_groups_[group_number].get_joint_names().size();
-          dyn_point.groups.push_back(dyn_group);
-
-          dyn_point.num_groups = 1;
-          dyn_traj.points.push_back(dyn_point);
+          ROS_ERROR("Joint trajectory action failing on invalid trajectory");
+          active_goal_map_[group_number].setAborted();
+          has_active_goal_map_[group_number] = false;
+          return;
         }
-        dyn_traj.header = gh.getGoal()->trajectory.header;
-        dyn_traj.joint_names = gh.getGoal()->trajectory.joint_names;
+        dyn_traj->header = traj.header;
+        dyn_traj->joint_names = robot_groups_[group_number].get_joint_names();
         this->pub_trajectories_[group_number].publish(dyn_traj);
       }
     }
@@ -418,21 +329,6 @@ void JointTrajectoryAction::goalCB(JointTractoryActionServer::GoalHandle gh, int
     rslt.error_code = control_msgs::FollowJointTrajectoryResult::INVALID_GOAL;
     gh.setRejected(rslt, "Empty trajectory");
   }
-
-  // Adding some informational log messages to indicate unsupported goal constraints
-  if (gh.getGoal()->goal_time_tolerance.toSec() > 0.0)
-  {
-    ROS_WARN_STREAM("Ignoring goal time tolerance in action goal, may be supported in the future");
-  }
-  if (!gh.getGoal()->goal_tolerance.empty())
-  {
-    ROS_WARN_STREAM(
-      "Ignoring goal tolerance in action, using paramater tolerance of " << goal_threshold_ << " instead");
-  }
-  if (!gh.getGoal()->path_tolerance.empty())
-  {
-    ROS_WARN_STREAM("Ignoring goal path tolerance, option not supported by ROS-Industrial drivers");
-  }
 }
 
 void JointTrajectoryAction::cancelCB(
@@ -475,17 +371,37 @@ void JointTrajectoryAction::controllerStateCB(
     return;
   }
 
-  if (!industrial_utils::isSimilar(robot_groups_[robot_id].get_joint_names(), msg->joint_names))
+  // Compares the feedback to the goal, and passes the desired positions and errors on as action feedback
+  GoalMonitor &monitor = goal_monitor_map_[robot_id];
+  control_msgs::FollowJointTrajectoryFeedback &feedback = action_feedback_map_[robot_id];
+  if (!monitor.update(*msg, &feedback))
   {
     ROS_ERROR("Joint names from the controller don't match our joint names.");
     return;
   }
+  active_goal_map_[robot_id].publishFeedback(feedback);
+
+  if (!monitor.pathViolation().empty())
+  {
+    ROS_WARN_STREAM("Aborting goal because joint " << monitor.pathViolation() << " is outside of its path tolerance");
+    abortGoal(robot_id, control_msgs::FollowJointTrajectoryResult::PATH_TOLERANCE_VIOLATED,
+              "Joint " + monitor.pathViolation() + " outside of its path tolerance");
+    return;
+  }
 
   // Checking for goal constraints
   // Checks that we have ended inside the goal constraints and has motion stopped
 
   ROS_DEBUG("Checking goal constraints");
-  if (withinGoalConstraints(last_trajectory_state_map_[robot_id], current_traj_map_[robot_id], robot_id))
+  if (monitor.withinGoal() && monitor.trajectoryEnded())
+  {
+    // Each joint is within its own tolerance at the end of the trajectory, which doesn't have to
+    // wait for the robot to report that it stopped
+    ROS_INFO("Inside goal constraints at the end of the trajectory, return success for action");
+    active_goal_map_[robot_id].setSucceeded();
+    has_active_goal_map_[robot_id] = false;
+  }
+  else if (monitor.withinGoal())
   {
     if (last_robot_status_)
     {
@@ -519,6 +435,12 @@ void JointTrajectoryAction::controllerStateCB(
       has_active_goal_map_[robot_id] = false;
     }
   }
+  else if (monitor.goalTimeExceeded())
+  {
+    ROS_WARN("Aborting goal because the goal constraints weren't reached within the goal time tolerance");
+    abortGoal(robot_id, control_msgs::FollowJointTrajectoryResult::GOAL_TOLERANCE_VIOLATED,
+              "Goal constraints not reached within the goal time tolerance");
+  }
 }
 
 void JointTrajectoryAction::controllerStateCB(
@@ -607,38 +529,22 @@ void JointTrajectoryAction::abortGoal(int robot_id)
   has_active_goal_map_[robot_id] = false;
 }
 
-bool JointTrajectoryAction::withinGoalConstraints(
-  const control_msgs::FollowJointTrajectoryFeedbackConstPtr &msg,
-  const trajectory_msgs::JointTrajectory & traj)
+void JointTrajectoryAction::abortGoal(int robot_id, int error_code, const std::string &error_string)
 {
-  bool rtn = false;
-  if (traj.points.empty())
-  {
-    ROS_WARN("Empty joint trajectory passed to check goal constraints, return false");
-    rtn = false;
-  }
-  else
-  {
-    int last_point = traj.points.size() - 1;
+  // Stops the controller.
+  motoman_msgs::DynamicJointTrajectory empty;
+  pub_trajectories_[robot_id].publish(empty);
 
-    if (industrial_robot_client::utils::isWithinRange(
-          last_trajectory_state_->joint_names,
-          last_trajectory_state_->actual.positions, traj.joint_names,
-          traj.points[last_point].positions, goal_threshold_))
-    {
-      rtn = true;
-    }
-    else
-    {
-      rtn = false;
-    }
-  }
-  return rtn;
+  // Marks the current goal as aborted.
+  control_msgs::FollowJointTrajectoryResult rslt;
+  rslt.error_code = error_code;
+  active_goal_map_[robot_id].setAborted(rslt, error_string);
+  has_active_goal_map_[robot_id] = false;
 }
 
 bool JointTrajectoryAction::withinGoalConstraints(
   const control_msgs::FollowJointTrajectoryFeedbackConstPtr &msg,
-  const trajectory_msgs::JointTrajectory & traj, int robot_id)
+  const trajectory_msgs::JointTrajectory & traj)
 {
   bool rtn = false;
   if (traj.points.empty())
@@ -650,11 +556,9 @@ bool JointTrajectoryAction::withinGoalConstraints(
   {
     int last_point = traj.points.size() - 1;
 
-    int group_number = robot_id;
-
     if (industrial_robot_client::utils::isWithinRange(
-          robot_groups_[group_number].get_joint_names(),
-          last_trajectory_state_map_[group_number]->actual.positions, traj.joint_names,
+          last_trajectory_state_->joint_names,
+          last_trajectory_state_->actual.positions, traj.joint_names,
           traj.points[last_point].positions, goal_threshold_))
     {
       rtn = true;
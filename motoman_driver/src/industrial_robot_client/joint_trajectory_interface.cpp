@@ -30,6 +30,8 @@
  */
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include "motoman_driver/industrial_robot_client/joint_trajectory_interface.h"
 #include "motoman_driver/industrial_robot_client/motoman_utils.h"
 #include "simple_message/joint_traj_pt.h"
@@ -116,7 +118,7 @@ bool JointTrajectoryInterface::init(SmplMsgConnection* connection, const std::ve
   if (joint_vel_limits_.empty()
       && !industrial_utils::param::getJointVelocityLimits("robot_description", joint_vel_limits_))
     ROS_WARN("Unable to read velocity limits from 'robot_description' param.  Velocity validation disabled.");
-
+  load_acceleration_limits(joint_names);
 
   this->srv_stop_motion_ = this->node_.advertiseService(
                              "stop_motion", &JointTrajectoryInterface::stopMotionCB, this);
@@ -146,6 +148,8 @@ bool JointTrajectoryInterface::init(
       && !industrial_utils::param::getJointVelocityLimits(
         "robot_description", joint_vel_limits_))
     ROS_WARN("Unable to read velocity limits from 'robot_description' param.  Velocity validation disabled.");
+  for (it_type iterator = this->robot_groups_.begin(); iterator != this->robot_groups_.end(); iterator++)
+    load_acceleration_limits(iterator->second.get_joint_names());
 
   // General server and subscriber for compounded trajectories
   this->srv_joint_trajectory_ = this->node_.advertiseService(
@@ -182,6 +186,7 @@ bool JointTrajectoryInterface::init(
     this->srv_joints_[robot_id] = srv_joint_trajectory;
     this->sub_joint_trajectories_[robot_id] = sub_joint_trajectory;
 
+    this->cur_joint_pos_map_[robot_id] = sensor_msgs::JointStateConstPtr();
     this->sub_cur_pos_ = this->node_.subscribe<sensor_msgs::JointState>(
                            ns_str + "/" + name_str + "/joint_states", 1,
                            boost::bind(&JointTrajectoryInterface::jointStateCB, this, _1, robot_id));
@@ -290,15 +295,18 @@ bool JointTrajectoryInterface::trajectory_to_msgs(
       return false;
     }
 
+    // the robot joints of each group are looked up once, and gathered from all points by index
+    std::map<int, std::vector<int> > group_indices;
+    last_time_from_start_.clear();  // durations are relative to the previous point of this trajectory
     for (size_t i = 0; i < traj->points.size(); ++i)
     {
       SimpleMessage msg;
       ros_dynamicPoint rbt_pt, xform_pt;
 
-
-      if (!select(traj->joint_names, traj->points[i].groups[0],
-                  robot_groups_[traj->points[i].groups[0].group_number].get_joint_names(),
-                  &rbt_pt))
+      const ros_dynamicPoint& ros_pt = traj->points[i].groups[0];
+      const std::vector<int>* ros_indices = find_joint_indices(traj->joint_names, ros_pt.group_number,
+                                                               &group_indices);
+      if (!ros_indices || !select(*ros_indices, ros_pt, &rbt_pt))
         return false;
 
       // transform point data (e.g. for joint-coupling)
@@ -335,14 +343,19 @@ bool JointTrajectoryInterface::trajectory_to_msgs(
   if (!is_valid(*traj))
     return false;
 
+  // the robot joints are looked up once, and gathered from all points by index
+  std::vector<int> ros_indices;
+  if (!find_joint_indices(traj->joint_names, this->all_joint_names_, &ros_indices))
+    return false;
+
+  last_time_from_start_.clear();  // durations are relative to the previous point of this trajectory
   for (size_t i = 0; i < traj->points.size(); ++i)
   {
     SimpleMessage msg;
     ros_JointTrajPt rbt_pt, xform_pt;
 
     // select / reorder joints for sending to robot
-    if (!select(traj->joint_names, traj->points[i],
-                this->all_joint_names_, &rbt_pt))
+    if (!select(ros_indices, traj->points[i], &rbt_pt))
       return false;
 
     // transform point data (e.g. for joint-coupling)
@@ -359,56 +372,64 @@ bool JointTrajectoryInterface::trajectory_to_msgs(
   return true;
 }
 
-bool JointTrajectoryInterface::select(
+bool JointTrajectoryInterface::find_joint_indices(
   const std::vector<std::string>& ros_joint_names,
-  const ros_dynamicPoint& ros_pt,
-  const std::vector<std::string>& rbt_joint_names, ros_dynamicPoint* rbt_pt)
+  const std::vector<std::string>& rbt_joint_names, std::vector<int>* ros_indices)
 {
-  ROS_ASSERT(ros_joint_names.size() == ros_pt.positions.size());
-  // initialize rbt_pt
-  *rbt_pt = ros_pt;
-  rbt_pt->positions.clear();
-  rbt_pt->velocities.clear();
-  rbt_pt->accelerations.clear();
-
+  ros_indices->resize(rbt_joint_names.size());
   for (size_t rbt_idx = 0; rbt_idx < rbt_joint_names.size(); ++rbt_idx)
   {
-    bool is_empty = rbt_joint_names[rbt_idx].empty();
+    if (rbt_joint_names[rbt_idx].empty())
+    {
+      (*ros_indices)[rbt_idx] = -1;
+      continue;
+    }
 
     // find matching ROS element
-    size_t ros_idx = std::find(ros_joint_names.begin(),
-                               ros_joint_names.end(),
+    size_t ros_idx = std::find(ros_joint_names.begin(), ros_joint_names.end(),
                                rbt_joint_names[rbt_idx]) - ros_joint_names.begin();
-    bool is_found = ros_idx < ros_joint_names.size();
-
 
     // error-chk: required robot joint not found in ROS joint-list
-    if (!is_empty && !is_found)
+    if (ros_idx >= ros_joint_names.size())
     {
-      ROS_ERROR("Expected joint (%s) not found in JointTrajectory.Aborting command.",
+      ROS_ERROR("Expected joint (%s) not found in JointTrajectory.  Aborting command.",
                 rbt_joint_names[rbt_idx].c_str());
       return false;
     }
-
-    if (is_empty)
-    {
-      if (!ros_pt.positions.empty()) rbt_pt->positions.push_back(default_joint_pos_);
-      if (!ros_pt.velocities.empty()) rbt_pt->velocities.push_back(-1);
-      if (!ros_pt.accelerations.empty()) rbt_pt->accelerations.push_back(-1);
-    }
-    else
-    {
-      if (!ros_pt.positions.empty())
-        rbt_pt->positions.push_back(ros_pt.positions[ros_idx]);
-      if (!ros_pt.velocities.empty())
-        rbt_pt->velocities.push_back(ros_pt.velocities[ros_idx]);
-      if (!ros_pt.accelerations.empty())
-        rbt_pt->accelerations.push_back(ros_pt.accelerations[ros_idx]);
-    }
+    (*ros_indices)[rbt_idx] = ros_idx;
   }
   return true;
 }
 
+const std::vector<int>* JointTrajectoryInterface::find_joint_indices(
+  const std::vector<std::string>& ros_joint_names, int group_number,
+  std::map<int, std::vector<int> >* group_indices)
+{
+  std::map<int, std::vector<int> >::iterator it = group_indices->find(group_number);
+  if (it != group_indices->end())
+    return &it->second;
+
+  std::vector<int>& ros_indices = (*group_indices)[group_number];
+  if (!find_joint_indices(ros_joint_names, robot_groups_[group_number].get_joint_names(), &ros_indices))
+  {
+    group_indices->erase(group_number);
+    return NULL;
+  }
+  return &ros_indices;
+}
+
+bool JointTrajectoryInterface::select(
+  const std::vector<std::string>& ros_joint_names,
+  const ros_dynamicPoint& ros_pt,
+  const std::vector<std::string>& rbt_joint_names, ros_dynamicPoint* rbt_pt)
+{
+  ROS_ASSERT(ros_joint_names.size() == ros_pt.positions.size());
+
+  std::vector<int> ros_indices;
+  if (!find_joint_indices(ros_joint_names, rbt_joint_names, &ros_indices))
+    return false;
+  return select(ros_indices, ros_pt, rbt_pt);
+}
 
 bool JointTrajectoryInterface::select(
   const std::vector<std::string>& ros_joint_names,
@@ -416,42 +437,51 @@ bool JointTrajectoryInterface::select(
   ros_JointTrajPt* rbt_pt)
 {
   ROS_ASSERT(ros_joint_names.size() == ros_pt.positions.size());
-  // initialize rbt_pt
-  *rbt_pt = ros_pt;
-  rbt_pt->positions.clear();
-  rbt_pt->velocities.clear();
-  rbt_pt->accelerations.clear();
-
-  for (size_t rbt_idx = 0; rbt_idx < rbt_joint_names.size(); ++rbt_idx)
-  {
-    bool is_empty = rbt_joint_names[rbt_idx].empty();
 
-    // find matching ROS element
-    size_t ros_idx = std::find(ros_joint_names.begin(), ros_joint_names.end(),
-                               rbt_joint_names[rbt_idx]) - ros_joint_names.begin();
-    bool is_found = ros_idx < ros_joint_names.size();
+  std::vector<int> ros_indices;
+  if (!find_joint_indices(ros_joint_names, rbt_joint_names, &ros_indices))
+    return false;
+  return select(ros_indices, ros_pt, rbt_pt);
+}
 
-    // error-chk: required robot joint not found in ROS joint-list
-    if (!is_empty && !is_found)
-    {
-      ROS_ERROR("Expected joint (%s) not found in JointTrajectory.  Aborting command.",
-                rbt_joint_names[rbt_idx].c_str());
-      return false;
-    }
+// gathers the values of the robot joints, fill_value for the unused (empty) ones
+static void select_joints(const std::vector<int>& ros_indices, const std::vector<double>& ros_values,
+                          double fill_value, std::vector<double>* rbt_values)
+{
+  rbt_values->clear();
+  if (ros_values.empty())
+    return;
 
-    if (is_empty)
-    {
-      if (!ros_pt.positions.empty()) rbt_pt->positions.push_back(default_joint_pos_);
-      if (!ros_pt.velocities.empty()) rbt_pt->velocities.push_back(-1);
-      if (!ros_pt.accelerations.empty()) rbt_pt->accelerations.push_back(-1);
-    }
-    else
-    {
-      if (!ros_pt.positions.empty()) rbt_pt->positions.push_back(ros_pt.positions[ros_idx]);
-      if (!ros_pt.velocities.empty()) rbt_pt->velocities.push_back(ros_pt.velocities[ros_idx]);
-      if (!ros_pt.accelerations.empty()) rbt_pt->accelerations.push_back(ros_pt.accelerations[ros_idx]);
-    }
+  rbt_values->resize(ros_indices.size());
+  for (size_t rbt_idx = 0; rbt_idx < ros_indices.size(); ++rbt_idx)
+  {
+    const int ros_idx = ros_indices[rbt_idx];
+    (*rbt_values)[rbt_idx] = (ros_idx < 0) ? fill_value : ros_values[ros_idx];
   }
+}
+
+bool JointTrajectoryInterface::select(const std::vector<int>& ros_indices, const ros_dynamicPoint& ros_pt,
+                                      ros_dynamicPoint* rbt_pt)
+{
+  rbt_pt->group_number = ros_pt.group_number;
+  rbt_pt->num_joints = ros_pt.num_joints;
+  rbt_pt->valid_fields = ros_pt.valid_fields;
+  rbt_pt->effort = ros_pt.effort;
+  rbt_pt->time_from_start = ros_pt.time_from_start;
+  select_joints(ros_indices, ros_pt.positions, default_joint_pos_, &rbt_pt->positions);
+  select_joints(ros_indices, ros_pt.velocities, -1, &rbt_pt->velocities);
+  select_joints(ros_indices, ros_pt.accelerations, -1, &rbt_pt->accelerations);
+  return true;
+}
+
+bool JointTrajectoryInterface::select(const std::vector<int>& ros_indices, const ros_JointTrajPt& ros_pt,
+                                      ros_JointTrajPt* rbt_pt)
+{
+  rbt_pt->effort = ros_pt.effort;
+  rbt_pt->time_from_start = ros_pt.time_from_start;
+  select_joints(ros_indices, ros_pt.positions, default_joint_pos_, &rbt_pt->positions);
+  select_joints(ros_indices, ros_pt.velocities, -1, &rbt_pt->velocities);
+  select_joints(ros_indices, ros_pt.accelerations, -1, &rbt_pt->accelerations);
   return true;
 }
 
@@ -557,18 +587,20 @@ bool JointTrajectoryInterface::calc_velocity(const motoman_msgs::DynamicJointsGr
   return true;
 }
 
+double JointTrajectoryInterface::calc_duration(double time_from_start, double last_time_from_start) const
+{
+  if (time_from_start <= last_time_from_start)  // earlier time => new trajectory.  Move slowly to first point.
+    return default_duration_;
+  return time_from_start - last_time_from_start;
+}
+
 bool JointTrajectoryInterface::calc_duration
 (const trajectory_msgs::JointTrajectoryPoint& pt, double* rbt_duration)
 {
-  std::vector<double> durations;
   double this_time = pt.time_from_start.toSec();
-  static double last_time = 0;
-
-  if (this_time <= last_time)  // earlier time => new trajectory.  Move slowly to first point.
-    *rbt_duration = default_duration_;
-  else
-    *rbt_duration = this_time - last_time;
+  double& last_time = last_time_from_start_[-1];  // JointTrajectory points have no group
 
+  *rbt_duration = calc_duration(this_time, last_time);
   last_time = this_time;
 
   return true;
@@ -577,15 +609,10 @@ bool JointTrajectoryInterface::calc_duration
 bool JointTrajectoryInterface::calc_duration(
   const motoman_msgs::DynamicJointsGroup& pt, double* rbt_duration)
 {
-  std::vector<double> durations;
   double this_time = pt.time_from_start.toSec();
-  static double last_time = 0;
-
-  if (this_time <= last_time)  // earlier time => new trajectory.  Move slowly to first point.
-    *rbt_duration = default_duration_;
-  else
-    *rbt_duration = this_time - last_time;
+  double& last_time = last_time_from_start_[pt.group_number];
 
+  *rbt_duration = calc_duration(this_time, last_time);
   last_time = this_time;
 
   return true;
@@ -668,8 +695,59 @@ bool JointTrajectoryInterface::stopMotionCB(
   return true;  // always return true.  To distinguish between call-failed and service-unavailable.
 }
 
+// acceleration limits aren't part of the URDF, they are read from the joint limits of the MoveIt configuration
+void JointTrajectoryInterface::load_acceleration_limits(const std::vector<std::string> &joint_names)
+{
+  // checking them rejects trajectories that used to be accepted, so it is opt-in
+  if (!node_.param("check_acceleration_limits", false))
+    return;
+
+  for (size_t i = 0; i < joint_names.size(); ++i)
+  {
+    if (joint_names[i].empty())
+      continue;
+
+    const std::string limits_ns = "robot_description_planning/joint_limits/" + joint_names[i];
+    bool has_limit = false;
+    double max_acc;
+    if (node_.getParam(limits_ns + "/has_acceleration_limits", has_limit) && has_limit &&
+        node_.getParam(limits_ns + "/max_acceleration", max_acc))
+      joint_acc_limits_[joint_names[i]] = max_acc;
+  }
+}
+
+// looks the limit of each trajectory joint up once, joints without a limit get an infinite one
+static void resolve_limits(const std::vector<std::string> &joint_names, const std::map<std::string, double> &limits,
+                           std::vector<double>* joint_limits)
+{
+  joint_limits->assign(joint_names.size(), std::numeric_limits<double>::infinity());
+  for (size_t j = 0; j < joint_names.size(); ++j)
+  {
+    std::map<std::string, double>::const_iterator limit = limits.find(joint_names[j]);
+    if (limit != limits.end())
+      (*joint_limits)[j] = limit->second;
+  }
+}
+
+// returns the index of the first value that exceeds its limit, or values.size() if none does
+static size_t find_exceeded_limit(const std::vector<double> &values, const std::vector<double> &joint_limits)
+{
+  const size_t num_values = std::min(values.size(), joint_limits.size());
+  for (size_t j = 0; j < num_values; ++j)
+  {
+    if (std::abs(values[j]) > joint_limits[j])
+      return j;
+  }
+  return values.size();
+}
+
 bool JointTrajectoryInterface::is_valid(const trajectory_msgs::JointTrajectory &traj)
 {
+  // the limits are looked up once, then checked point by point against the dense arrays
+  std::vector<double> max_vel, max_acc;
+  resolve_limits(traj.joint_names, joint_vel_limits_, &max_vel);
+  resolve_limits(traj.joint_names, joint_acc_limits_, &max_acc);
+
   for (size_t i = 0; i < traj.points.size(); ++i)
   {
     const trajectory_msgs::JointTrajectoryPoint &pt = traj.points[i];
@@ -678,20 +756,21 @@ bool JointTrajectoryInterface::is_valid(const trajectory_msgs::JointTrajectory &
     if (pt.positions.empty())
       ROS_ERROR_RETURN(false, "Validation failed: Missing position data for trajectory pt %lu", i);
 
-    // check for joint velocity limits
-    for (size_t j = 0; j < pt.velocities.size(); ++j)
-    {
-      std::map<std::string, double>::iterator max_vel = joint_vel_limits_.find(traj.joint_names[j]);
-      if (max_vel == joint_vel_limits_.end()) continue;  // no velocity-checking if limit not defined
-
-      if (std::abs(pt.velocities[j]) > max_vel->second)
-        ROS_ERROR_RETURN(false, "Validation failed: Max velocity exceeded for trajectory pt %lu, joint '%s'", i,
-                         traj.joint_names[j].c_str());
-    }
+    // check for joint velocity and acceleration limits
+    size_t j = find_exceeded_limit(pt.velocities, max_vel);
+    if (j < pt.velocities.size())
+      ROS_ERROR_RETURN(false, "Validation failed: Max velocity exceeded for trajectory pt %lu, joint '%s'", i,
+                       traj.joint_names[j].c_str());
+    j = find_exceeded_limit(pt.accelerations, max_acc);
+    if (j < pt.accelerations.size())
+      ROS_ERROR_RETURN(false, "Validation failed: Max acceleration exceeded for trajectory pt %lu, joint '%s'", i,
+                       traj.joint_names[j].c_str());
 
     // check for valid timestamp
     if ((i > 0) && (pt.time_from_start.toSec() == 0))
       ROS_ERROR_RETURN(false, "Validation failed: Missing valid timestamp data for trajectory pt %lu", i);
+    if ((i > 0) && (pt.time_from_start <= traj.points[i - 1].time_from_start))
+      ROS_ERROR_RETURN(false, "Validation failed: Timestamp of trajectory pt %lu isn't after the previous one", i);
   }
 
   return true;
@@ -699,6 +778,10 @@ bool JointTrajectoryInterface::is_valid(const trajectory_msgs::JointTrajectory &
 
 bool JointTrajectoryInterface::is_valid(const motoman_msgs::DynamicJointTrajectory &traj)
 {
+  // the values of a group are in the joint order of the group, its limits are looked up once per trajectory
+  std::map<int, std::vector<double> > max_vel, max_acc;  // by group number
+
+  std::map<int, ros::Duration> last_time_from_start;  // by group number
   for (size_t i = 0; i < traj.points.size(); ++i)
   {
     for (int gr = 0; gr < traj.points[i].num_groups; gr++)
@@ -708,36 +791,73 @@ bool JointTrajectoryInterface::is_valid(const motoman_msgs::DynamicJointTrajecto
       // check for non-empty positions
       if (pt.positions.empty())
         ROS_ERROR_RETURN(false, "Validation failed: Missing position data for trajectory pt %lu", i);
-      // check for joint velocity limits
-      for (size_t j = 0; j < pt.velocities.size(); ++j)
-      {
-        std::map<std::string, double>::iterator max_vel = joint_vel_limits_.find(traj.joint_names[j]);
-        if (max_vel == joint_vel_limits_.end()) continue;  // no velocity-checking if limit not defined
 
-        if (std::abs(pt.velocities[j]) > max_vel->second)
-          ROS_ERROR_RETURN(false, "Validation failed: Max velocity exceeded for trajectory pt %lu, joint '%s'", i,
-                           traj.joint_names[j].c_str());
+      std::map<int, RobotGroup>::const_iterator group = robot_groups_.find(pt.group_number);
+      if (group == robot_groups_.end())
+        ROS_ERROR_RETURN(false, "Validation failed: Unknown group %d in trajectory pt %lu", pt.group_number, i);
+      const std::vector<std::string> &joint_names = group->second.get_joint_names();
+      std::vector<double> &group_max_vel = max_vel[pt.group_number];
+      std::vector<double> &group_max_acc = max_acc[pt.group_number];
+      if (group_max_vel.empty())
+      {
+        resolve_limits(joint_names, joint_vel_limits_, &group_max_vel);
+        resolve_limits(joint_names, joint_acc_limits_, &group_max_acc);
       }
 
+      // check for joint velocity and acceleration limits
+      size_t j = find_exceeded_limit(pt.velocities, group_max_vel);
+      if (j < pt.velocities.size())
+        ROS_ERROR_RETURN(false, "Validation failed: Max velocity exceeded for trajectory pt %lu, joint '%s'", i,
+                         joint_names[j].c_str());
+      j = find_exceeded_limit(pt.accelerations, group_max_acc);
+      if (j < pt.accelerations.size())
+        ROS_ERROR_RETURN(false, "Validation failed: Max acceleration exceeded for trajectory pt %lu, joint '%s'", i,
+                         joint_names[j].c_str());
+
       // check for valid timestamp
       if ((i > 0) && (pt.time_from_start.toSec() == 0))
         ROS_ERROR_RETURN(false, "Validation failed: Missing valid timestamp data for trajectory pt %lu", i);
+
+      std::map<int, ros::Duration>::iterator last_time = last_time_from_start.find(pt.group_number);
+      if (last_time == last_time_from_start.end())
+        last_time_from_start[pt.group_number] = pt.time_from_start;
+      else if (pt.time_from_start <= last_time->second)
+        ROS_ERROR_RETURN(false, "Validation failed: Timestamp of trajectory pt %lu isn't after the previous one", i);
+      else
+        last_time->second = pt.time_from_start;
     }
   }
   return true;
 }
 
-// copy robot JointState into local cache
+// keep robot JointState as the current position, the message is shared instead of copied
 void JointTrajectoryInterface::jointStateCB(
   const sensor_msgs::JointStateConstPtr &msg)
 {
-  this->cur_joint_pos_ = *msg;
+  const std::lock_guard<std::mutex> lock{cur_joint_pos_mutex_};
+  this->cur_joint_pos_ = msg;
 }
 
 void JointTrajectoryInterface::jointStateCB(
   const sensor_msgs::JointStateConstPtr &msg, int robot_id)
 {
-  this->cur_joint_pos_map_[robot_id] = *msg;
+  const std::lock_guard<std::mutex> lock{cur_joint_pos_mutex_};
+  this->cur_joint_pos_map_[robot_id] = msg;  // the entry exists, this doesn't allocate
+}
+
+sensor_msgs::JointStateConstPtr JointTrajectoryInterface::get_cur_joint_pos()
+{
+  const std::lock_guard<std::mutex> lock{cur_joint_pos_mutex_};
+  return this->cur_joint_pos_;
+}
+
+sensor_msgs::JointStateConstPtr JointTrajectoryInterface::get_cur_joint_pos(int robot_id)
+{
+  const std::lock_guard<std::mutex> lock{cur_joint_pos_mutex_};
+  std::map<int, sensor_msgs::JointStateConstPtr>::const_iterator cur_pos = this->cur_joint_pos_map_.find(robot_id);
+  if (cur_pos == this->cur_joint_pos_map_.end())
+    return sensor_msgs::JointStateConstPtr();
+  return cur_pos->second;
 }
 
 }  // namespace joint_trajectory_interface
@@ -31,7 +31,6 @@
 
 #include "motoman_driver/industrial_robot_client/joint_trajectory_streamer.h"
 #include <algorithm>
-#include <queue>
 #include <map>
 #include <vector>
 #include <string>
@@ -44,6 +43,8 @@ namespace industrial_robot_client
 namespace joint_trajectory_streamer
 {
 
+const int JointTrajectoryStreamer::default_ptstreaming_queue_size;
+
 bool JointTrajectoryStreamer::init(SmplMsgConnection* connection, const std::map<int, RobotGroup> &robot_groups,
                                    const std::map<std::string, double> &velocity_limits)
 {
@@ -53,6 +54,8 @@ bool JointTrajectoryStreamer::init(SmplMsgConnection* connection, const std::map
 
   rtn &= JointTrajectoryInterface::init(connection, robot_groups, velocity_limits);
 
+  initPointStreamingQueue();
+
   this->mutex_.lock();
   this->current_point_ = 0;
   this->state_ = TransferStates::IDLE;
@@ -73,6 +76,8 @@ bool JointTrajectoryStreamer::init(SmplMsgConnection* connection, const std::vec
 
   rtn &= JointTrajectoryInterface::init(connection, joint_names, velocity_limits);
 
+  initPointStreamingQueue();
+
   this->mutex_.lock();
   this->current_point_ = 0;
   this->state_ = TransferStates::IDLE;
@@ -87,6 +92,50 @@ bool JointTrajectoryStreamer::init(SmplMsgConnection* connection, const std::vec
 JointTrajectoryStreamer::~JointTrajectoryStreamer()
 {
   delete this->streaming_thread_;
+  delete this->ptstreaming_queue_;
+}
+
+void JointTrajectoryStreamer::initPointStreamingQueue()
+{
+  int queue_size;
+  node_.param("point_streaming_queue_size", queue_size, default_ptstreaming_queue_size);
+  if (queue_size < 1)
+  {
+    ROS_WARN("Invalid point_streaming_queue_size %d, using %d", queue_size, default_ptstreaming_queue_size);
+    queue_size = default_ptstreaming_queue_size;
+  }
+
+  delete this->ptstreaming_queue_;
+  this->ptstreaming_queue_ = new boost::lockfree::spsc_queue<PointStreamingSlot>(queue_size);
+}
+
+void JointTrajectoryStreamer::notifyPointQueued()
+{
+  // The point was queued without holding mutex_. Taking it briefly makes sure the streaming thread either
+  // sees the point when it checks the queue, or is already waiting and gets woken up.
+  {
+    boost::lock_guard<boost::mutex> lock(this->mutex_);
+  }
+  this->streaming_cond_.notify_one();
+}
+
+void JointTrajectoryStreamer::makeRequest(SimpleMessage* msg)
+{
+  if (msg->getCommType() == CommTypes::SERVICE_REQUEST)
+    return;
+
+  SimpleMessage tmpMsg = *msg;
+  msg->init(tmpMsg.getMessageType(), CommTypes::SERVICE_REQUEST,
+            ReplyTypes::INVALID, tmpMsg.getData());  // set commType=REQUEST
+}
+
+SerializedTrajectoryPtr JointTrajectoryStreamer::serializeTrajectory(const std::vector<SimpleMessage>& messages)
+{
+  SerializedTrajectoryPtr traj(new std::vector<SimpleMessage>(messages));
+  for (size_t i = 0; i < traj->size(); ++i)
+    makeRequest(&(*traj)[i]);
+
+  return traj;
 }
 
 void JointTrajectoryStreamer::jointTrajectoryCB(const motoman_msgs::DynamicJointTrajectoryConstPtr &msg)
@@ -102,7 +151,7 @@ void JointTrajectoryStreamer::jointTrajectoryCB(const motoman_msgs::DynamicJoint
     if (msg->points.empty())
       ROS_INFO("Empty trajectory received, canceling current trajectory");
     else
-      ROS_ERROR("Trajectory splicing not yet implemented, stopping current motion.");
+      ROS_ERROR("Trajectory can't be spliced into the current one, stopping current motion.");
 
     this->mutex_.lock();
     trajectoryStop();
@@ -138,7 +187,7 @@ void JointTrajectoryStreamer::jointTrajectoryCB(const trajectory_msgs::JointTraj
     if (msg->points.empty())
       ROS_INFO("Empty trajectory received, canceling current trajectory");
     else
-      ROS_ERROR("Trajectory splicing not yet implemented, stopping current motion.");
+      ROS_ERROR("Trajectory can't be spliced into the current one, stopping current motion.");
 
     this->mutex_.lock();
     trajectoryStop();
@@ -238,7 +287,7 @@ void JointTrajectoryStreamer::jointCommandExCB(const motoman_msgs::DynamicJointT
     this->mutex_.lock();
     this->state_ = TransferStates::POINT_STREAMING;
     this->ptstreaming_seq_count_ = 0;
-    this->ptstreaming_queue_ = std::queue<SimpleMessage>();
+    this->streaming_session_++;  // points left in the queue belong to an earlier session and are dropped
     this->mutex_.unlock();
 
     // Set the local state to point streaming to force enqueuing of the starting point
@@ -286,7 +335,7 @@ void JointTrajectoryStreamer::jointCommandExCB(const motoman_msgs::DynamicJointT
       pt_time_from_start = max_time_from_start;
     }
 
-    if (ptstreaming_queue_.size() > max_ptstreaming_queue_elements)  // Check for max queue size
+    if (!ptstreaming_queue_->write_available())  // Check for max queue size
     {
       ROS_ERROR("Point streaming queue has reached max allowed elements");
       stop_trajectory = true;
@@ -323,18 +372,20 @@ void JointTrajectoryStreamer::jointCommandExCB(const motoman_msgs::DynamicJointT
       return;
     **/
 
-    SimpleMessage message;
-    create_message_ex(this->ptstreaming_seq_count_, msg->points[0], &message);
+    // serialize the point into the request sent to the robot, the streaming thread sends it as it is
+    PointStreamingSlot slot;
+    create_message_ex(this->ptstreaming_seq_count_, msg->points[0], &slot.message);
+    makeRequest(&slot.message);
 
     // Update the last time from start
     // Note: last_time_from_start_ variable is only used in this function therefore we do not need to wrap in lock
     ptstreaming_last_time_from_start_ = pt_time_from_start;
 
     // Points get pushed into queue here. They will be popped in the Streaming Thread and sent to controller.
-    this->mutex_.lock();
-    this->ptstreaming_queue_.push(message);
+    slot.session = this->streaming_session_;
+    this->ptstreaming_queue_->push(slot);
     this->ptstreaming_seq_count_++;
-    this->mutex_.unlock();
+    notifyPointQueued();
   }
 
   //Else, cannot splice. Cancel current motion.
@@ -417,7 +468,7 @@ void JointTrajectoryStreamer::jointCommandCB(const trajectory_msgs::JointTraject
     this->mutex_.lock();
     this->state_ = TransferStates::POINT_STREAMING;
     this->ptstreaming_seq_count_ = 0;
-    this->ptstreaming_queue_ = std::queue<SimpleMessage>();
+    this->streaming_session_++;  // points left in the queue belong to an earlier session and are dropped
     this->mutex_.unlock();
 
     // Set the local state to point streaming to force enqueuing of the starting point
@@ -455,7 +506,7 @@ void JointTrajectoryStreamer::jointCommandCB(const trajectory_msgs::JointTraject
       }
     }
 
-    if (ptstreaming_queue_.size() > max_ptstreaming_queue_elements)  // Check for max queue size
+    if (!ptstreaming_queue_->write_available())  // Check for max queue size
     {
       ROS_ERROR("Point streaming queue has reached max allowed elements");
       stop_trajectory = true;
@@ -485,20 +536,21 @@ void JointTrajectoryStreamer::jointCommandCB(const trajectory_msgs::JointTraject
     if (!transform(rbt_pt, &xform_pt))
       return;
 
-    SimpleMessage message;
-    // convert trajectory point to ROS message
-    if (!create_message(this->ptstreaming_seq_count_, xform_pt, &message))
+    // convert trajectory point to ROS message, serialized into the request sent to the robot
+    PointStreamingSlot slot;
+    if (!create_message(this->ptstreaming_seq_count_, xform_pt, &slot.message))
       return;
+    makeRequest(&slot.message);
 
     // Update the last time from start
     // Note: last_time_from_start_ variable is only used in this function therefore we do not need to wrap in lock
     ptstreaming_last_time_from_start_ = pt_time_from_start;
 
     // Points get pushed into queue here. They will be popped in the Streaming Thread and sent to controller.
-    this->mutex_.lock();
-    this->ptstreaming_queue_.push(message);
+    slot.session = this->streaming_session_;
+    this->ptstreaming_queue_->push(slot);
     this->ptstreaming_seq_count_++;
-    this->mutex_.unlock();
+    notifyPointQueued();
   }
 
   //Else, cannot splice. Cancel current motion.
@@ -519,15 +571,18 @@ void JointTrajectoryStreamer::jointCommandCB(const trajectory_msgs::JointTraject
 bool JointTrajectoryStreamer::send_to_robot(const std::vector<SimpleMessage>& messages)
 {
   ROS_INFO("Loading trajectory, setting state to streaming");
+  SerializedTrajectoryPtr traj = serializeTrajectory(messages);
   this->mutex_.lock();
   {
     ROS_INFO("Executing trajectory of size: %d", static_cast<int>(messages.size()));
-    this->current_traj_ = messages;
+    this->current_traj_ = traj;
     this->current_point_ = 0;
     this->state_ = TransferStates::STREAMING;
+    this->streaming_session_++;
     this->streaming_start_ = ros::Time::now();
   }
   this->mutex_.unlock();
+  this->streaming_cond_.notify_one();
 
   return true;
 }
@@ -597,7 +652,7 @@ void JointTrajectoryStreamer::streamingThread()
 
     this->mutex_.lock();
 
-    SimpleMessage msg, tmpMsg, reply;
+    SimpleMessage reply;
 
     switch (this->state_)
     {
@@ -606,7 +661,7 @@ void JointTrajectoryStreamer::streamingThread()
       break;
 
     case TransferStates::STREAMING:
-      if (this->current_point_ >= static_cast<int>(this->current_traj_.size()))
+      if (this->current_point_ >= static_cast<int>(this->current_traj_->size()))
       {
         ROS_INFO("Trajectory streaming complete, setting state to IDLE");
         this->state_ = TransferStates::IDLE;
@@ -620,15 +675,11 @@ void JointTrajectoryStreamer::streamingThread()
         break;
       }
 
-      tmpMsg = this->current_traj_[this->current_point_];
-      msg.init(tmpMsg.getMessageType(), CommTypes::SERVICE_REQUEST,
-               ReplyTypes::INVALID, tmpMsg.getData());  // set commType=REQUEST
-
       ROS_DEBUG("Sending joint trajectory point");
-      if (this->connection_->sendAndReceiveMsg(msg, reply, false))
+      if (this->connection_->sendAndReceiveMsg((*this->current_traj_)[this->current_point_], reply, false))
       {
         ROS_INFO("Point[%d of %d] sent to controller",
-                 this->current_point_, static_cast<int>(this->current_traj_.size()));
+                 this->current_point_, static_cast<int>(this->current_traj_->size()));
         this->current_point_++;
       }
       else
@@ -638,8 +689,13 @@ void JointTrajectoryStreamer::streamingThread()
 
     case TransferStates::POINT_STREAMING:
 
+      // drop points of earlier point streaming sessions
+      while (this->ptstreaming_queue_->read_available() &&
+             this->ptstreaming_queue_->front().session != this->streaming_session_)
+        this->ptstreaming_queue_->pop();
+
       // if no points in queue, streaming complete, set to idle.
-      if (this->ptstreaming_queue_.empty())
+      if (!this->ptstreaming_queue_->read_available())
       {
         ROS_INFO("Point streaming complete, setting state to IDLE");
         this->state_ = TransferStates::IDLE;
@@ -652,20 +708,16 @@ void JointTrajectoryStreamer::streamingThread()
         connectRetryCount = 5;
         break;
       }
-      // otherwise, send point to robot.
-      tmpMsg = this->ptstreaming_queue_.front();
-      this->ptstreaming_queue_.pop();
-      msg.init(tmpMsg.getMessageType(), CommTypes::SERVICE_REQUEST,
-               ReplyTypes::INVALID, tmpMsg.getData());  // set commType=REQUEST
-
+      // otherwise, send point to robot (as it was queued, the queue slot is only reused after the pop).
       ROS_DEBUG("Sending joint trajectory point");
-      if (this->connection_->sendAndReceiveMsg(msg, reply, false))
+      if (this->connection_->sendAndReceiveMsg(this->ptstreaming_queue_->front().message, reply, false))
       {
         ROS_INFO("Point[%d] sent to controller", this->current_point_);
         this->current_point_++;
       }
       else
         ROS_WARN("Failed sent joint point, will try again");
+      this->ptstreaming_queue_->pop();
 
       break;
       // TODO Consider checking for controller point starvation here. use a
@@ -692,6 +744,8 @@ void JointTrajectoryStreamer::trajectoryStop()
 
   ROS_DEBUG("Stop command sent, entering idle mode");
   this->state_ = TransferStates::IDLE;
+  this->streaming_session_++;
+  this->streaming_cond_.notify_one();
 }
 
 }  // namespace joint_trajectory_streamer
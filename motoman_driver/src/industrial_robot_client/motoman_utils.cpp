@@ -33,6 +33,7 @@
 
 #include "motoman_driver/industrial_robot_client/motoman_utils.h"
 #include "ros/ros.h"
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -121,6 +122,98 @@ bool getJointGroups(const std::string topic_param, std::map<int, RobotGroup> & r
   }
 }
 
+// copies the values of a group's joints from a point, or zeros if the point has none
+static bool gatherJoints(const std::vector<double> &values, const std::vector<int> &ros_indices, size_t num_ros_joints,
+                         std::vector<double> *group_values)
+{
+  group_values->resize(ros_indices.size());
+  if (values.empty())
+  {
+    std::fill(group_values->begin(), group_values->end(), 0.0);
+    return true;
+  }
+  if (values.size() < num_ros_joints)
+    return false;
+
+  for (size_t j = 0; j < ros_indices.size(); ++j)
+    (*group_values)[j] = values[ros_indices[j]];
+  return true;
+}
+
+bool toDynamicJointTrajectory(const trajectory_msgs::JointTrajectory &traj,
+                              const std::map<int, RobotGroup> &robot_groups,
+                              motoman_msgs::DynamicJointTrajectory *dyn_traj)
+{
+  const size_t num_ros_joints = traj.joint_names.size();
+
+  // look up the trajectory joint of each joint of each group once, for all points
+  std::vector<int> group_numbers;
+  std::vector<std::vector<int> > group_indices;  // empty for groups that aren't in the trajectory
+  std::vector<size_t> group_num_joints;
+  for (std::map<int, RobotGroup>::const_iterator it = robot_groups.begin(); it != robot_groups.end(); ++it)
+  {
+    const std::vector<std::string> &joint_names = it->second.get_joint_names();
+    std::vector<int> ros_indices;
+    for (size_t j = 0; j < joint_names.size(); ++j)
+    {
+      const size_t ros_idx = std::find(traj.joint_names.begin(), traj.joint_names.end(), joint_names[j])
+                             - traj.joint_names.begin();
+      if (ros_idx < num_ros_joints)
+      {
+        ros_indices.push_back(ros_idx);
+      }
+      else if (j > 0)
+      {
+        ROS_ERROR("Joint '%s' of group %d is not in the trajectory", joint_names[j].c_str(), it->first);
+        return false;
+      }
+      else
+      {
+        break;  // the group isn't in the trajectory
+      }
+    }
+    group_numbers.push_back(it->first);
+    group_indices.push_back(ros_indices);
+    group_num_joints.push_back(joint_names.size());
+  }
+
+  const size_t num_groups = group_numbers.size();
+  dyn_traj->points.resize(traj.points.size());
+  for (size_t i = 0; i < traj.points.size(); ++i)
+  {
+    const trajectory_msgs::JointTrajectoryPoint &pt = traj.points[i];
+    motoman_msgs::DynamicJointPoint &dpoint = dyn_traj->points[i];
+    dpoint.num_groups = num_groups;
+    dpoint.groups.resize(num_groups);
+
+    for (size_t gr = 0; gr < num_groups; ++gr)
+    {
+      motoman_msgs::DynamicJointsGroup &dyn_group = dpoint.groups[gr];
+      const std::vector<int> &ros_indices = group_indices[gr];
+      dyn_group.group_number = group_numbers[gr];
+      dyn_group.num_joints = group_num_joints[gr];
+      dyn_group.time_from_start = pt.time_from_start;
+
+      if (ros_indices.empty())
+      {
+        dyn_group.positions.assign(group_num_joints[gr], 0.0);
+        dyn_group.velocities.assign(group_num_joints[gr], 0.0);
+        dyn_group.accelerations.assign(group_num_joints[gr], 0.0);
+        dyn_group.effort.assign(group_num_joints[gr], 0.0);
+      }
+      else if (!gatherJoints(pt.positions, ros_indices, num_ros_joints, &dyn_group.positions) ||
+               !gatherJoints(pt.velocities, ros_indices, num_ros_joints, &dyn_group.velocities) ||
+               !gatherJoints(pt.accelerations, ros_indices, num_ros_joints, &dyn_group.accelerations) ||
+               !gatherJoints(pt.effort, ros_indices, num_ros_joints, &dyn_group.effort))
+      {
+        ROS_ERROR("Trajectory point %lu has fewer values than joints", i);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 }  // namespace motoman_utils
 }  // namespace industrial_robot_client
 
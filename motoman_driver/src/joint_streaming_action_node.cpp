@@ -0,0 +1,58 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "motoman_driver/industrial_robot_client/joint_trajectory_action.h"
+#include "motoman_driver/joint_trajectory_streamer.h"
+
+using industrial_robot_client::joint_trajectory_action::JointTrajectoryAction;
+using motoman::joint_trajectory_streamer::MotomanJointTrajectoryStreamer;
+
+// Runs the motion streaming interface and the (multi-group) joint trajectory action in one
+// process.  The action publishes its trajectories as pointers, which roscpp hands to
+// subscribers in the same process as they are, without serializing them.
+int main(int argc, char** argv)
+{
+  const int FS100_motion_port = 50240;  // FS100 uses a "non-standard" port to comply with MotoPlus guidelines
+
+  // initialize node
+  ros::init(argc, argv, "motion_interface");
+
+  // launch the FS100 JointTrajectoryStreamer connection/handlers
+  MotomanJointTrajectoryStreamer motionInterface;
+  motionInterface.init("", FS100_motion_port, false);
+
+  JointTrajectoryAction action;
+
+  // spins the callbacks of both, as they arrive
+  motionInterface.run();
+
+  return 0;
+}
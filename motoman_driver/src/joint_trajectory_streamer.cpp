@@ -33,26 +33,32 @@
 #include "motoman_driver/simple_message/messages/motoman_motion_reply_message.h"
 #include "simple_message/messages/joint_traj_pt_full_message.h"
 #include "motoman_driver/simple_message/messages/joint_traj_pt_full_ex_message.h"
+#include "motoman_driver/simple_message/messages/joint_traj_pt_full_multi_message.h"
 #include "industrial_robot_client/utils.h"
 #include "industrial_utils/param_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <map>
 #include <vector>
 #include <string>
 
 #include "std_msgs/UInt32.h"
 
-namespace CommTypes = industrial::simple_message::CommTypes;
-namespace ReplyTypes = industrial::simple_message::ReplyTypes;
 using industrial::joint_data::JointData;
 using industrial::joint_traj_pt_full::JointTrajPtFull;
 using industrial::joint_traj_pt_full_message::JointTrajPtFullMessage;
 using industrial::joint_traj_pt_full_ex::JointTrajPtFullEx;
 using industrial::joint_traj_pt_full_ex_message::JointTrajPtFullExMessage;
+using industrial::joint_traj_pt_full_multi::JointTrajPtFullMulti;
+using industrial::joint_traj_pt_full_multi_message::JointTrajPtFullMultiMessage;
 using industrial::shared_types::shared_int;
 
 using motoman::simple_message::motion_reply_message::MotionReplyMessage;
 namespace TransferStates = industrial_robot_client::joint_trajectory_streamer::TransferStates;
 namespace MotionReplyResults = motoman::simple_message::motion_reply::MotionReplyResults;
+namespace MotionReplySubcodes = motoman::simple_message::motion_reply::MotionReplySubcodes;
 
 namespace motoman
 {
@@ -63,6 +69,29 @@ namespace
 {
   const double pos_stale_time_ = 1.0;  // max time since last "current position" update, for validation (sec)
   const double start_pos_tol_  = 1e-4;  // max difference btwn start & current position, for validation (rad)
+  const double retry_delay_ = 0.004;  // time before resending a point that was rejected as BUSY or failed (sec)
+  const double splice_vel_tol_ = 1e-3;  // max velocity difference btwn splice point & new trajectory start (rad/s)
+  const int max_streaming_window_size_ = 8;  // trajectory points MotoROS queues per group (TRAJ_PT_Q_SIZE)
+
+  bool isSameState(const std::vector<double> &positions, const std::vector<double> &velocities,
+                   const std::vector<double> &ref_positions, const std::vector<double> &ref_velocities,
+                   double pos_tol)
+  {
+    if (positions.size() != ref_positions.size() || velocities.size() != ref_velocities.size())
+      return false;
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+      if (std::abs(positions[i] - ref_positions[i]) > pos_tol)
+        return false;
+    }
+    for (size_t i = 0; i < velocities.size(); ++i)
+    {
+      if (std::abs(velocities[i] - ref_velocities[i]) > splice_vel_tol_)
+        return false;
+    }
+    return true;
+  }
 }
 
 #define ROS_ERROR_RETURN(rtn, ...) do {ROS_ERROR(__VA_ARGS__); return(rtn);} while (0)  // NOLINT(whitespace/braces)
@@ -70,18 +99,28 @@ namespace
 void MotomanJointTrajectoryStreamer::run()
 {
   /* ros::Publisher queue_size_pub = node_.advertise<std_msgs::UInt32>("robot_streaming_queue_size", 10); */
-  ros::Publisher queue_size_pub = node_.advertise<std_msgs::UInt32>("robot_transfer_state", 10);
-  ros::Rate loop_rate(100);
-  unsigned int val;
-  while (ros::ok()) {
-    /* val = this->ptstreaming_queue_.size(); */
-    val = this->state_;
-    std_msgs::UInt32 msg;
-    msg.data = val;
-    queue_size_pub.publish(msg);
-    ros::spinOnce();
-    loop_rate.sleep();
-  }
+  this->transfer_state_pub_ = node_.advertise<std_msgs::UInt32>("robot_transfer_state", 10);
+  ros::Timer transfer_state_timer = node_.createTimer(ros::Duration(0.01),
+                                                      &MotomanJointTrajectoryStreamer::publishTransferState, this);
+
+  // callbacks are handled as they arrive, not at the rate the transfer state is published at
+  ros::spin();
+}
+
+void MotomanJointTrajectoryStreamer::publishTransferState(const ros::TimerEvent &e)
+{
+  std_msgs::UInt32 msg;
+  /* msg.data = this->ptstreaming_queue_->read_available(); */
+  msg.data = this->state_;
+  this->transfer_state_pub_.publish(msg);
+}
+
+// override init() to remember the controller address, for the motion control connection
+bool MotomanJointTrajectoryStreamer::init(std::string default_ip, int default_port, bool version_0)
+{
+  ros::param::param<std::string>("robot_ip_address", control_ip_, default_ip);
+  ros::param::param<int>("~port", control_port_, default_port);
+  return JointTrajectoryStreamer::init(default_ip, default_port, version_0);
 }
 
 // override init() to read "robot_id" parameter and subscribe to joint_states
@@ -95,13 +134,20 @@ bool MotomanJointTrajectoryStreamer::init(SmplMsgConnection* connection, const s
   this->robot_groups_ = robot_groups;
   rtn &= JointTrajectoryStreamer::init(connection, robot_groups, velocity_limits);
 
-  motion_ctrl_.init(connection, 0);
+  node_.param("streaming_window_size", streaming_window_size_, 1);
+  node_.param("streaming_points_per_message", streaming_points_per_message_, 1);
+  if ((streaming_points_per_message_ > 1) && (robot_groups_.size() >= 4))
+    ROS_WARN("streaming_points_per_message is %d, but a JointTrajPtFullMulti message only holds a single point of "
+             "%d groups", streaming_points_per_message_, static_cast<int>(robot_groups_.size()));
+  SmplMsgConnection* control_connection = initControlConnection(connection);
+
+  motion_ctrl_.init(control_connection, 0);
   for (size_t i = 0; i < robot_groups_.size(); i++)
   {
     MotomanMotionCtrl motion_ctrl;
 
     int robot_id = robot_groups_[i].get_group_id();
-    rtn &= motion_ctrl.init(connection, robot_id);
+    rtn &= motion_ctrl.init(control_connection, robot_id);
 
     motion_ctrl_map_[robot_id] = motion_ctrl;
   }
@@ -129,7 +175,10 @@ bool MotomanJointTrajectoryStreamer::init(SmplMsgConnection* connection, const s
   if ((robot_id_ < 0))
     node_.param("robot_id", robot_id_, 0);
 
-  rtn &= motion_ctrl_.init(connection, robot_id_);
+  node_.param("streaming_window_size", streaming_window_size_, 1);
+  node_.param("streaming_points_per_message", streaming_points_per_message_, 1);
+
+  rtn &= motion_ctrl_.init(initControlConnection(connection), robot_id_);
 
   disabler_ = node_.advertiseService("robot_disable", &MotomanJointTrajectoryStreamer::disableRobotCB, this);
 
@@ -140,11 +189,51 @@ bool MotomanJointTrajectoryStreamer::init(SmplMsgConnection* connection, const s
   return rtn;
 }
 
+SmplMsgConnection* MotomanJointTrajectoryStreamer::initControlConnection(SmplMsgConnection* connection)
+{
+  node_.param("motion_reply_timeout", reply_timeout_, 10.0);
+  const int reply_timeout_ms = static_cast<int>(reply_timeout_ * 1000.0);
+  if (connection == &this->default_tcp_connection_)
+    this->default_tcp_connection_.setReplyTimeout(reply_timeout_ms);
+
+  node_.param("motion_control_connection", use_control_connection_, false);
+  if (!use_control_connection_)
+    return connection;
+
+  if (control_ip_.empty())
+  {
+    ROS_WARN("No controller address for the motion control connection, sending motion control commands on the "
+             "streaming connection");
+    use_control_connection_ = false;
+    return connection;
+  }
+
+  char* ip_addr = strdup(control_ip_.c_str());  // connection.init() requires "char*", not "const char*"
+  ROS_INFO("Motion control connecting to IP address: '%s:%d'", ip_addr, control_port_);
+  control_connection_.init(ip_addr, control_port_);
+  control_connection_.setReplyTimeout(reply_timeout_ms);
+  free(ip_addr);
+  control_connection_.makeConnect();
+  return &control_connection_;
+}
+
+std::unique_lock<std::mutex> MotomanJointTrajectoryStreamer::lockControlConnection()
+{
+  std::unique_lock<std::mutex> lock(use_control_connection_ ? control_conx_mutex_ : smpl_msg_conx_mutex_);
+  SmplMsgConnection* connection = use_control_connection_ ? &control_connection_ : this->connection_;
+  if (!connection->isConnected())  // e.g. closed after a reply timeout
+  {
+    ROS_INFO("Connecting to robot motion server for motion control");
+    connection->makeConnect();
+  }
+  return lock;
+}
+
 MotomanJointTrajectoryStreamer::~MotomanJointTrajectoryStreamer()
 {
   // SmplMsgConnection is not thread safe, so lock first
   // NOTE: motion_ctrl_ uses the SmplMsgConnection here
-  const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+  const std::unique_lock<std::mutex> lock = lockControlConnection();
   // TODO( ): Find better place to call StopTrajMode
   motion_ctrl_.setTrajMode(false);   // release TrajMode, so INFORM jobs can run
 }
@@ -157,7 +246,7 @@ bool MotomanJointTrajectoryStreamer::disableRobotCB(std_srvs::Trigger::Request &
   {
     // SmplMsgConnection is not thread safe, so lock first
     // NOTE: motion_ctrl_ uses the SmplMsgConnection here
-    const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+    const std::unique_lock<std::mutex> lock = lockControlConnection();
     res.success = motion_ctrl_.setTrajMode(false);
   }
 
@@ -180,7 +269,7 @@ bool MotomanJointTrajectoryStreamer::enableRobotCB(std_srvs::Trigger::Request& r
   {
     // SmplMsgConnection is not thread safe, so lock first
     // NOTE: motion_ctrl_ uses the SmplMsgConnection here
-    const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+    const std::unique_lock<std::mutex> lock = lockControlConnection();
     res.success = motion_ctrl_.setTrajMode(true);
   }
 
@@ -206,7 +295,7 @@ bool MotomanJointTrajectoryStreamer::selectToolCB(motoman_msgs::SelectTool::Requ
   {
     // SmplMsgConnection is not thread safe, so lock first
     // NOTE: motion_ctrl_ uses the SmplMsgConnection here
-    const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+    const std::unique_lock<std::mutex> lock = lockControlConnection();
     res.success = motion_ctrl_.selectToolFile(req.group_number, req.tool_number, err_msg);
   }
 
@@ -440,10 +529,30 @@ bool MotomanJointTrajectoryStreamer::send_to_robot(const std::vector<SimpleMessa
   {
     // SmplMsgConnection is not thread safe, so lock first
     // NOTE: motion_ctrl_ uses the SmplMsgConnection here
-    const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+    const std::unique_lock<std::mutex> lock = lockControlConnection();
     motion_ctrl_result = motion_ctrl_.controllerReady();
   }
 
+  if (this->streaming_window_size_ > max_streaming_window_size_)
+  {
+    ROS_WARN("MotoROS queues %d points per group, reducing streaming_window_size from %d",
+             max_streaming_window_size_, this->streaming_window_size_);
+    this->streaming_window_size_ = max_streaming_window_size_;
+  }
+
+  if (motion_ctrl_result && (this->streaming_window_size_ > 1))
+  {
+    // the controller only enforces the point order streaming windows rely on when asked to, on the connection
+    // the points are streamed on (not the motion control connection)
+    MotomanMotionCtrl sequence_ctrl;
+    const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+    if (!sequence_ctrl.init(this->connection_, 0) || !sequence_ctrl.startSequenceCheck())
+    {
+      ROS_WARN("Falling back to a streaming_window_size of 1");
+      this->streaming_window_size_ = 1;
+    }
+  }
+
   if (!motion_ctrl_result)
     ROS_ERROR_RETURN(false, "Failed to initialize MotoRos motion, trajectory execution ABORTED. If safe, call the "
                             "'robot_enable' service to (re-)enable Motoplus motion and retry.");
@@ -451,6 +560,234 @@ bool MotomanJointTrajectoryStreamer::send_to_robot(const std::vector<SimpleMessa
   return JointTrajectoryStreamer::send_to_robot(messages);
 }
 
+// override jointTrajectoryCB to splice new trajectories into the current one, instead of stopping
+void MotomanJointTrajectoryStreamer::jointTrajectoryCB(const trajectory_msgs::JointTrajectoryConstPtr &msg)
+{
+  // spliceTrajectory checks that a trajectory is being streamed, under mutex_
+  if (!msg->points.empty() && spliceTrajectory(*msg))
+    return;
+
+  int session;
+  {
+    boost::lock_guard<boost::mutex> lock(this->mutex_);
+    session = this->streaming_session_;
+  }
+  JointTrajectoryStreamer::jointTrajectoryCB(msg);
+
+  // remember the trajectory if it was loaded, for splicing the next one
+  boost::lock_guard<boost::mutex> lock(this->mutex_);
+  if ((session != this->streaming_session_) && (TransferStates::STREAMING == this->state_))
+  {
+    current_ros_traj_ = msg;
+    current_ros_traj_ex_.reset();
+  }
+}
+
+// override jointTrajectoryExCB to splice new trajectories into the current one, instead of restarting
+void MotomanJointTrajectoryStreamer::jointTrajectoryExCB(const motoman_msgs::DynamicJointTrajectoryConstPtr &msg)
+{
+  // spliceTrajectory checks that a trajectory is being streamed, under mutex_
+  if (!msg->points.empty() && spliceTrajectory(*msg))
+    return;
+
+  int session;
+  {
+    boost::lock_guard<boost::mutex> lock(this->mutex_);
+    if (TransferStates::IDLE != this->state_)
+    {
+      // like JointTrajectoryStreamer::jointTrajectoryCB, a trajectory that can't be spliced in stops the motion.
+      // It doesn't start where the robot is, so it couldn't be executed after the current one anyway.
+      if (msg->points.empty())
+        ROS_INFO("Empty trajectory received, canceling current trajectory");
+      else
+        ROS_ERROR("Trajectory can't be spliced into the current one, stopping current motion.");
+      trajectoryStop();
+      return;
+    }
+    session = this->streaming_session_;
+  }
+  JointTrajectoryStreamer::jointTrajectoryExCB(msg);
+
+  // remember the trajectory if it was loaded, for splicing the next one
+  boost::lock_guard<boost::mutex> lock(this->mutex_);
+  if ((session != this->streaming_session_) && (TransferStates::STREAMING == this->state_))
+  {
+    current_ros_traj_ex_ = msg;
+    current_ros_traj_.reset();
+  }
+}
+
+size_t MotomanJointTrajectoryStreamer::firstUnsentPoint() const
+{
+  // the streaming thread may be sending a window of points starting at current_point_ without holding mutex_
+  return static_cast<size_t>(this->current_point_ +
+                             std::max(std::max(this->streaming_window_size_, this->streaming_points_per_message_), 1));
+}
+
+bool MotomanJointTrajectoryStreamer::spliceTrajectory(const trajectory_msgs::JointTrajectory &traj)
+{
+  boost::lock_guard<boost::mutex> lock(this->mutex_);
+
+  if ((TransferStates::STREAMING != this->state_) || !current_ros_traj_ ||
+      (current_ros_traj_->points.size() != this->current_traj_->size()) ||
+      (current_ros_traj_->joint_names != traj.joint_names))
+    return false;
+
+  if (!JointTrajectoryInterface::is_valid(traj))
+    return false;
+
+  for (size_t i = 0; i < traj.points.size(); ++i)
+  {
+    // FS100 requires valid velocity data
+    if (traj.points[i].velocities.empty())
+      ROS_ERROR_RETURN(false, "Validation failed: Missing velocity data for trajectory pt %lu", i);
+  }
+
+  // find the first point that wasn't sent yet and matches the start of the new trajectory
+  const std::vector<trajectory_msgs::JointTrajectoryPoint> &points = current_ros_traj_->points;
+  size_t splice_point = firstUnsentPoint();
+  for (; splice_point < points.size(); ++splice_point)
+  {
+    if (isSameState(traj.points[0].positions, traj.points[0].velocities,
+                    points[splice_point].positions, points[splice_point].velocities, start_pos_tol_))
+      break;
+  }
+  if (splice_point >= points.size())
+    ROS_ERROR_RETURN(false, "Trajectory doesn't start at a state the current trajectory is still going to pass, "
+                            "it can't be spliced in");
+
+  trajectory_msgs::JointTrajectoryPtr spliced(new trajectory_msgs::JointTrajectory);
+  spliced->header = traj.header;
+  spliced->joint_names = traj.joint_names;
+  spliced->points.reserve(splice_point + traj.points.size());
+  spliced->points.assign(points.begin(), points.begin() + splice_point);
+
+  // rebase the new trajectory on the time of the splice point
+  const ros::Duration time_offset = points[splice_point].time_from_start - traj.points[0].time_from_start;
+
+  // the loaded trajectory may be in use by the streaming thread, so the spliced one is a new trajectory
+  SerializedTrajectoryPtr spliced_traj(new std::vector<SimpleMessage>());
+  spliced_traj->reserve(splice_point + traj.points.size());
+  spliced_traj->assign(this->current_traj_->begin(), this->current_traj_->begin() + splice_point);
+  std::vector<int> ros_indices;
+  if (!find_joint_indices(traj.joint_names, this->all_joint_names_, &ros_indices))
+    return false;
+  for (size_t i = 0; i < traj.points.size(); ++i)
+  {
+    trajectory_msgs::JointTrajectoryPoint pt = traj.points[i];
+    pt.time_from_start += time_offset;
+
+    trajectory_msgs::JointTrajectoryPoint rbt_pt, xform_pt;
+    SimpleMessage msg;
+    if (!select(ros_indices, pt, &rbt_pt) ||
+        !transform(rbt_pt, &xform_pt) ||
+        !create_message(splice_point + i, xform_pt, &msg))
+      return false;
+
+    spliced_traj->push_back(msg);
+    spliced->points.push_back(pt);
+  }
+
+  this->current_traj_ = spliced_traj;
+  current_ros_traj_ = spliced;
+
+  ROS_INFO("Spliced trajectory of size %d into the current one at point %d",
+           static_cast<int>(traj.points.size()), static_cast<int>(splice_point));
+  return true;
+}
+
+bool MotomanJointTrajectoryStreamer::spliceTrajectory(const motoman_msgs::DynamicJointTrajectory &traj)
+{
+  boost::lock_guard<boost::mutex> lock(this->mutex_);
+
+  if ((TransferStates::STREAMING != this->state_) || !current_ros_traj_ex_ ||
+      (current_ros_traj_ex_->points.size() != this->current_traj_->size()) ||
+      (current_ros_traj_ex_->joint_names != traj.joint_names))
+    return false;
+
+  if (!JointTrajectoryInterface::is_valid(traj))
+    return false;
+
+  for (size_t i = 0; i < traj.points.size(); ++i)
+  {
+    for (int gr = 0; gr < traj.points[i].num_groups; gr++)
+    {
+      // FS100 requires valid velocity data
+      if (traj.points[i].groups[gr].velocities.empty())
+        ROS_ERROR_RETURN(false, "Validation failed: Missing velocity data for trajectory pt %lu", i);
+    }
+  }
+
+  // find the first point that wasn't sent yet and matches the start of the new trajectory (for all groups)
+  const motoman_msgs::DynamicJointPoint &start = traj.points[0];
+  const std::vector<motoman_msgs::DynamicJointPoint> &points = current_ros_traj_ex_->points;
+  size_t splice_point = firstUnsentPoint();
+  for (; splice_point < points.size(); ++splice_point)
+  {
+    const motoman_msgs::DynamicJointPoint &pt = points[splice_point];
+    if (pt.num_groups != start.num_groups)
+      continue;
+
+    bool is_same = true;
+    for (int gr = 0; is_same && gr < start.num_groups; gr++)
+    {
+      is_same = (pt.groups[gr].group_number == start.groups[gr].group_number) &&
+                isSameState(start.groups[gr].positions, start.groups[gr].velocities,
+                            pt.groups[gr].positions, pt.groups[gr].velocities, start_pos_tol_);
+    }
+    if (is_same)
+      break;
+  }
+  if (splice_point >= points.size())
+    ROS_ERROR_RETURN(false, "Trajectory doesn't start at a state the current trajectory is still going to pass, "
+                            "it can't be spliced in");
+
+  motoman_msgs::DynamicJointTrajectoryPtr spliced(new motoman_msgs::DynamicJointTrajectory);
+  spliced->header = traj.header;
+  spliced->joint_names = traj.joint_names;
+  spliced->points.reserve(splice_point + traj.points.size());
+  spliced->points.assign(points.begin(), points.begin() + splice_point);
+
+  // the loaded trajectory may be in use by the streaming thread, so the spliced one is a new trajectory
+  SerializedTrajectoryPtr spliced_traj(new std::vector<SimpleMessage>());
+  spliced_traj->reserve(splice_point + traj.points.size());
+  spliced_traj->assign(this->current_traj_->begin(), this->current_traj_->begin() + splice_point);
+  std::map<int, std::vector<int> > group_indices;
+  for (size_t i = 0; i < traj.points.size(); ++i)
+  {
+    motoman_msgs::DynamicJointPoint dpoint = traj.points[i];
+
+    // rebase the new trajectory on the time of the splice point
+    for (int gr = 0; gr < dpoint.num_groups; gr++)
+      dpoint.groups[gr].time_from_start += points[splice_point].groups[gr].time_from_start -
+                                           start.groups[gr].time_from_start;
+
+    SimpleMessage msg;
+    if (dpoint.num_groups == 1)
+    {
+      motoman_msgs::DynamicJointsGroup rbt_pt, xform_pt;
+      const std::vector<int>* ros_indices = find_joint_indices(traj.joint_names, dpoint.groups[0].group_number,
+                                                               &group_indices);
+      if (!ros_indices || !select(*ros_indices, dpoint.groups[0], &rbt_pt) ||
+          !transform(rbt_pt, &xform_pt) ||
+          !create_message(splice_point + i, xform_pt, &msg))
+        return false;
+    }
+    else if (!create_message_ex(splice_point + i, dpoint, &msg))
+      return false;
+
+    spliced_traj->push_back(msg);
+    spliced->points.push_back(dpoint);
+  }
+
+  this->current_traj_ = spliced_traj;
+  current_ros_traj_ex_ = spliced;
+
+  ROS_INFO("Spliced trajectory of size %d into the current one at point %d",
+           static_cast<int>(traj.points.size()), static_cast<int>(splice_point));
+  return true;
+}
+
 // override streamingThread, to provide check/retry of MotionReply.result=BUSY
 void MotomanJointTrajectoryStreamer::streamingThread()
 {
@@ -461,8 +798,6 @@ void MotomanJointTrajectoryStreamer::streamingThread()
   ROS_INFO("Starting Motoman joint trajectory streamer thread");
   while (ros::ok())
   {
-    ros::Duration(0.005).sleep();
-
     // automatically re-establish connection, if required
     if (connectRetryCount-- > 0)
     {
@@ -495,18 +830,22 @@ void MotomanJointTrajectoryStreamer::streamingThread()
     }
 
     // this does not lock smpl_msg_conx_mutex_, but the mutex from JointTrajectoryStreamer
-    this->mutex_.lock();
+    boost::unique_lock<boost::mutex> lock(this->mutex_);
 
-    SimpleMessage msg, tmpMsg, reply;
+    SimpleMessage reply;
+    bool delay_retry = false;
+    int session = this->streaming_session_;
+    SerializedTrajectoryPtr traj = this->current_traj_;  // keeps the trajectory alive while sending without mutex_
 
     switch (this->state_)
     {
     case TransferStates::IDLE:
-      ros::Duration(0.250).sleep();  //  slower loop while waiting for new trajectory
+      // wait for a new trajectory or point, the timeout only serves to notice a ROS shutdown
+      this->streaming_cond_.wait_for(lock, boost::chrono::milliseconds(250));
       break;
 
     case TransferStates::STREAMING:
-      if (this->current_point_ >= static_cast<int>(this->current_traj_.size()))
+      if (this->current_point_ >= static_cast<int>(traj->size()))
       {
         ROS_INFO("Trajectory streaming complete, setting state to IDLE");
         this->state_ = TransferStates::IDLE;
@@ -528,20 +867,52 @@ void MotomanJointTrajectoryStreamer::streamingThread()
         break;
       }
 
-      tmpMsg = this->current_traj_[this->current_point_];
-      msg.init(tmpMsg.getMessageType(), CommTypes::SERVICE_REQUEST,
-               ReplyTypes::INVALID, tmpMsg.getData());
+      if (this->current_point_ == 0)
+        ROS_DEBUG("Sending first point, %f s after the trajectory was received",
+                  (ros::Time::now() - this->streaming_start_).toSec());
 
-      is_msg_sent = false;
+      if (this->streaming_points_per_message_ > 1)
       {
-        // SmplMsgConnection is not thread safe, so lock first
-        const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
-        is_msg_sent = this->connection_->sendAndReceiveMsg(msg, reply, false);
+        if (!streamPointBatch(lock, &delay_retry))
+        {
+          ROS_WARN("Failed sent joint points, will try again");
+          delay_retry = true;
+        }
+        break;
       }
 
+      if (this->streaming_window_size_ > 1)
+      {
+        if (!streamPointWindow(lock, &delay_retry))
+        {
+          ROS_WARN("Failed sent joint points, will try again");
+          delay_retry = true;
+        }
+        break;
+      }
+
+      {
+        // the message was serialized into a request when the trajectory was loaded, send it as it is
+        SimpleMessage &msg = (*traj)[this->current_point_];
+
+        // don't hold mutex_ during the round trip, so new commands aren't blocked by it
+        lock.unlock();
+        is_msg_sent = false;
+        {
+          // SmplMsgConnection is not thread safe, so lock first
+          const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+          is_msg_sent = this->connection_->sendAndReceiveMsg(msg, reply, false);
+        }
+        lock.lock();
+      }
+
+      if (session != this->streaming_session_)
+        break;  // the trajectory was stopped or replaced meanwhile, the reply doesn't matter anymore
+
       if (!is_msg_sent)
       {
         ROS_WARN("Failed sent joint point, will try again");
+        delay_retry = true;
       }
       else
       {
@@ -556,11 +927,11 @@ void MotomanJointTrajectoryStreamer::streamingThread()
         if (reply_status.reply_.getResult() == MotionReplyResults::SUCCESS)
         {
           ROS_DEBUG("Point[%d of %d] sent to controller",
-                    this->current_point_, static_cast<int>(this->current_traj_.size()));
+                    this->current_point_, static_cast<int>(traj->size()));
           this->current_point_++;
         }
         else if (reply_status.reply_.getResult() == MotionReplyResults::BUSY)
-          break;  // silently retry sending this point
+          delay_retry = true;  // silently retry sending this point
         else
         {
           ROS_ERROR_STREAM("Aborting Trajectory.  Failed to send point"
@@ -573,13 +944,20 @@ void MotomanJointTrajectoryStreamer::streamingThread()
       break;
 
     case TransferStates::POINT_STREAMING:
+      // drop points of earlier point streaming sessions
+      while (this->ptstreaming_queue_->read_available() &&
+             this->ptstreaming_queue_->front().session != session)
+        this->ptstreaming_queue_->pop();
+
       // if no points in queue, streaming complete, set to idle.
-      if (this->ptstreaming_queue_.empty())
+      if (!this->ptstreaming_queue_->read_available())
       {
         if (this->dt_ptstreaming_points_ < this->ptstreaming_timeout_)
         {
+          // wait for the next point, without holding the mutex so it can be queued
+          const double remaining_time = this->ptstreaming_timeout_ - this->dt_ptstreaming_points_;
+          this->streaming_cond_.wait_for(lock, boost::chrono::duration<double>(std::max(remaining_time, 0.0)));
           this->dt_ptstreaming_points_ = ros::Time::now().toSec() - this->time_ptstreaming_last_point_;
-          ros::Duration(0.005).sleep();
           ROS_DEBUG("Time since last point: %f", this->dt_ptstreaming_points_);
           break;
         }
@@ -591,18 +969,39 @@ void MotomanJointTrajectoryStreamer::streamingThread()
         }
       }
       // if not connected, reconnect.
-      if (!this->connection_->isConnected())
+      is_connected = false;
+      {
+        // SmplMsgConnection is not thread safe, so lock first
+        const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+        is_connected = this->connection_->isConnected();
+      }
+
+      if (!is_connected)
       {
         ROS_DEBUG("Robot disconnected.  Attempting reconnect...");
         connectRetryCount = 5;
         break;
       }
-      // otherwise, send point to robot.
-      tmpMsg = this->ptstreaming_queue_.front();
-      msg.init(tmpMsg.getMessageType(), CommTypes::SERVICE_REQUEST,
-               ReplyTypes::INVALID, tmpMsg.getData());
+      // otherwise, send point to robot. It was queued as a request, and only this thread pops the queue,
+      // so it is sent from the queue slot as it is.
+      {
+        SimpleMessage &msg = this->ptstreaming_queue_->front().message;
+
+        // don't hold mutex_ during the round trip, so new commands aren't blocked by it
+        lock.unlock();
+        is_msg_sent = false;
+        {
+          // SmplMsgConnection is not thread safe, so lock first
+          const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+          is_msg_sent = this->connection_->sendAndReceiveMsg(msg, reply, false);
+        }
+        lock.lock();
+      }
+
+      if (session != this->streaming_session_)
+        break;  // point streaming was stopped meanwhile, the reply doesn't matter anymore
 
-      if (this->connection_->sendAndReceiveMsg(msg, reply, false))
+      if (is_msg_sent)
       {
         MotionReplyMessage reply_status;
         if (!reply_status.init(reply))
@@ -615,13 +1014,14 @@ void MotomanJointTrajectoryStreamer::streamingThread()
         {
           this->dt_ptstreaming_points_ = 0.0;
           this->time_ptstreaming_last_point_ = ros::Time::now().toSec();
-          this->ptstreaming_queue_.pop();
-          ROS_DEBUG("Point sent to controller, remaining points in queue [%lu]", this->ptstreaming_queue_.size());
+          this->ptstreaming_queue_->pop();
+          ROS_DEBUG("Point sent to controller, remaining points in queue [%lu]",
+                    this->ptstreaming_queue_->read_available());
         }
         else if (reply_status.reply_.getResult() == MotionReplyResults::BUSY)
         {
           ROS_DEBUG("silently resending.");
-          break;  // silently retry sending this point
+          delay_retry = true;  // silently retry sending this point
         }
         else
         {
@@ -633,7 +1033,10 @@ void MotomanJointTrajectoryStreamer::streamingThread()
         }
       }
       else
+      {
         ROS_WARN("Failed sent joint point, will try again");
+        delay_retry = true;
+      }
 
       break;
 
@@ -642,20 +1045,211 @@ void MotomanJointTrajectoryStreamer::streamingThread()
       this->state_ = TransferStates::IDLE;
       break;
     }
-    // this does not unlock smpl_msg_conx_mutex_, but the mutex from JointTrajectoryStreamer
-    this->mutex_.unlock();
+
+    // the controller can't take another point before it has processed the last one, give it one
+    // interpolation period (or the connection some time) unless a stop or a new trajectory comes in
+    if (delay_retry)
+      this->streaming_cond_.wait_for(lock, boost::chrono::duration<double>(retry_delay_));
   }
   ROS_WARN("Exiting trajectory streamer thread");
 }
 
+// Send up to streaming_window_size_ points before collecting their replies, so that the round trip to the
+// controller is paid once per window instead of once per point. MotoROS queues up to 8 points per group: a point
+// it can't take yet is replied with BUSY, and the points following it in the window with BUSY or INVALID/SEQUENCE.
+// The next window starts again at the first rejected point.
+bool MotomanJointTrajectoryStreamer::streamPointWindow(boost::unique_lock<boost::mutex>& lock, bool* busy)
+{
+  const int session = this->streaming_session_;
+  SerializedTrajectoryPtr traj = this->current_traj_;  // keeps the trajectory alive while sending without mutex_
+  const int first_point = this->current_point_;
+  const int num_points = std::min(this->streaming_window_size_,
+                                  static_cast<int>(traj->size()) - first_point);
+  std::vector<SimpleMessage> replies(num_points);
+
+  // don't hold mutex_ during the round trip, so new commands aren't blocked by it
+  lock.unlock();
+  int num_sent = 0;
+  int num_received = 0;
+  {
+    // SmplMsgConnection is not thread safe, so lock first. All replies are received
+    // before unlocking, so motion_ctrl_ never reads a reply meant for a point.
+    const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+    for (; num_sent < num_points; ++num_sent)
+    {
+      if (!this->connection_->sendMsg((*traj)[first_point + num_sent]))
+        break;
+    }
+    for (; num_received < num_sent; ++num_received)
+    {
+      if (!this->connection_->receiveMsg(replies[num_received]))
+        break;
+    }
+  }
+  lock.lock();
+
+  if (session != this->streaming_session_)
+    return true;  // the trajectory was stopped or replaced meanwhile, the replies don't matter anymore
+
+  bool rejected = false;
+  for (int i = 0; i < num_received; ++i)
+  {
+    const int point = first_point + i;
+    MotionReplyMessage reply_status;
+    if (!reply_status.init(replies[i]))
+    {
+      ROS_ERROR("Aborting trajectory: Unable to parse JointTrajectoryPoint reply");
+      this->state_ = TransferStates::IDLE;
+      return true;
+    }
+
+    if (reply_status.reply_.getSequence() != point)
+    {
+      ROS_ERROR("Aborting trajectory: Received reply for point #%d, expected #%d",
+                reply_status.reply_.getSequence(), point);
+      this->state_ = TransferStates::IDLE;
+      return true;
+    }
+
+    const shared_int result = reply_status.reply_.getResult();
+    if (result == MotionReplyResults::SUCCESS && !rejected)
+    {
+      ROS_DEBUG("Point[%d of %d] sent to controller",
+                point, static_cast<int>(traj->size()));
+      this->current_point_++;
+    }
+    else if (result == MotionReplyResults::SUCCESS)
+    {
+      ROS_ERROR("Aborting trajectory: Controller accepted point #%d after rejecting an earlier point. This MotoROS "
+                "version doesn't enforce the point order, set streaming_window_size to 1", point);
+      this->state_ = TransferStates::IDLE;
+      return true;
+    }
+    else if (result == MotionReplyResults::BUSY ||
+             (rejected && result == MotionReplyResults::INVALID &&
+              reply_status.reply_.getSubcode() == MotionReplySubcodes::Invalid::SEQUENCE))
+    {
+      rejected = true;  // silently resend from here with the next window
+      *busy = true;
+    }
+    else
+    {
+      ROS_ERROR_STREAM("Aborting Trajectory.  Failed to send point"
+                       << " (#" << point << "): "
+                       << MotomanMotionCtrl::getErrorString(reply_status.reply_));
+      this->state_ = TransferStates::IDLE;
+      return true;
+    }
+  }
+
+  return num_received == num_points;
+}
+
+// Send up to streaming_points_per_message points in a single JointTrajPtFullMulti message. MotoROS adds them to
+// the trajectory in order and sends back one reply for the message, with the number of points it accepted. The
+// next message starts at the first point that wasn't accepted.
+bool MotomanJointTrajectoryStreamer::streamPointBatch(boost::unique_lock<boost::mutex>& lock, bool* busy)
+{
+  const int session = this->streaming_session_;
+  SerializedTrajectoryPtr traj = this->current_traj_;  // keeps the trajectory alive while sending without mutex_
+  const int first_point = this->current_point_;
+
+  // don't hold mutex_ while building the message and during the round trip, so new commands aren't blocked by it
+  lock.unlock();
+  JointTrajPtFullMulti points;
+  int num_points = 0;
+  while ((num_points < this->streaming_points_per_message_) &&
+         (first_point + num_points < static_cast<int>(traj->size())) &&
+         points.addPoint((*traj)[first_point + num_points]))
+    num_points++;
+
+  JointTrajPtFullMultiMessage multi_msg;
+  SimpleMessage msg, reply;
+  multi_msg.init(points);
+  bool is_msg_sent = false;
+  if ((num_points > 0) && multi_msg.toRequest(msg))
+  {
+    // SmplMsgConnection is not thread safe, so lock first
+    const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
+    is_msg_sent = this->connection_->sendAndReceiveMsg(msg, reply, false);
+  }
+  lock.lock();
+
+  if (session != this->streaming_session_)
+    return true;  // the trajectory was stopped or replaced meanwhile, the reply doesn't matter anymore
+
+  if (num_points == 0)
+  {
+    ROS_ERROR("Aborting trajectory: Unable to add point #%d to a JointTrajPtFullMulti message", first_point);
+    this->state_ = TransferStates::IDLE;
+    return true;
+  }
+
+  if (!is_msg_sent)
+    return false;
+
+  MotionReplyMessage reply_status;
+  if (!reply_status.init(reply))
+  {
+    ROS_ERROR("Aborting trajectory: Unable to parse JointTrajPtFullMulti reply");
+    this->state_ = TransferStates::IDLE;
+    return true;
+  }
+
+  const int num_accepted = static_cast<int>(reply_status.reply_.getData(0));
+  if ((num_accepted < 0) || (num_accepted > num_points))
+  {
+    ROS_ERROR("Aborting trajectory: Controller accepted %d of the %d points sent", num_accepted, num_points);
+    this->state_ = TransferStates::IDLE;
+    return true;
+  }
+  this->current_point_ += num_accepted;
+  ROS_DEBUG("Points[%d to %d of %d] sent to controller",
+            first_point, this->current_point_ - 1, static_cast<int>(traj->size()));
+
+  const shared_int result = reply_status.reply_.getResult();
+  if (result == MotionReplyResults::BUSY)
+    *busy = true;  // silently resend the rest with the next message
+  else if ((result == MotionReplyResults::INVALID) &&
+           (reply_status.reply_.getSubcode() == MotionReplySubcodes::Invalid::MSGTYPE))
+  {
+    ROS_ERROR("Aborting trajectory: This MotoROS version doesn't support JointTrajPtFullMulti messages, set "
+              "streaming_points_per_message to 1");
+    this->state_ = TransferStates::IDLE;
+  }
+  else if (result != MotionReplyResults::SUCCESS)
+  {
+    ROS_ERROR_STREAM("Aborting Trajectory.  Failed to send point"
+                     << " (#" << this->current_point_ << "): "
+                     << MotomanMotionCtrl::getErrorString(reply_status.reply_));
+    this->state_ = TransferStates::IDLE;
+  }
+  return true;
+}
+
 // override trajectoryStop to send MotionCtrl message
 void MotomanJointTrajectoryStreamer::trajectoryStop()
 {
   this->state_ = TransferStates::IDLE;  // stop sending trajectory points
-  // SmplMsgConnection is not thread safe, so lock first
-  // NOTE: motion_ctrl_ uses the SmplMsgConnection here
-  const std::lock_guard<std::mutex> lock{smpl_msg_conx_mutex_};
-  motion_ctrl_.stopTrajectory();
+  this->streaming_session_++;  // discard replies to points that are still in flight
+  this->streaming_cond_.notify_one();
+  // on a separate control connection, the stop is sent right away, without waiting for points in flight.
+  // The controller could still queue such a point after stopping, so once its reply is in (or has timed
+  // out), the motion is stopped again.
+  std::unique_lock<std::mutex> streaming_lock(smpl_msg_conx_mutex_, std::defer_lock);
+  const bool point_in_flight = use_control_connection_ && !streaming_lock.try_lock();
+  {
+    // SmplMsgConnection is not thread safe, so lock first
+    // NOTE: motion_ctrl_ uses the SmplMsgConnection here
+    const std::unique_lock<std::mutex> lock = lockControlConnection();
+    motion_ctrl_.stopTrajectory();
+  }
+  if (point_in_flight)
+  {
+    streaming_lock.lock();
+    const std::unique_lock<std::mutex> lock = lockControlConnection();
+    motion_ctrl_.stopTrajectory();
+  }
 }
 
 // override is_valid to include FS100-specific checks
@@ -673,12 +1267,13 @@ bool MotomanJointTrajectoryStreamer::is_valid(const trajectory_msgs::JointTrajec
       ROS_ERROR_RETURN(false, "Validation failed: Missing velocity data for trajectory pt %lu", i);
   }
 
-  if ((cur_joint_pos_.header.stamp - ros::Time::now()).toSec() > pos_stale_time_)
+  const sensor_msgs::JointStateConstPtr cur_pos = get_cur_joint_pos();
+  if (!cur_pos || ((cur_pos->header.stamp - ros::Time::now()).toSec() > pos_stale_time_))
     ROS_ERROR_RETURN(false, "Validation failed: Can't get current robot position.");
 
   // FS100 requires trajectory start at current position
   namespace IRC_utils = industrial_robot_client::utils;
-  if (!IRC_utils::isWithinRange(cur_joint_pos_.name, cur_joint_pos_.position,
+  if (!IRC_utils::isWithinRange(cur_pos->name, cur_pos->position,
                                 traj.joint_names, traj.points[0].positions,
                                 start_pos_tol_))
   {
@@ -691,35 +1286,36 @@ bool MotomanJointTrajectoryStreamer::is_valid(const motoman_msgs::DynamicJointTr
 {
   if (!JointTrajectoryInterface::is_valid(traj))
     return false;
-  ros::Time time_stamp;
-  int group_number;
+
   for (size_t i = 0; i < traj.points.size(); ++i)
   {
     for (int gr = 0; gr < traj.points[i].num_groups; gr++)
     {
-      const motoman_msgs::DynamicJointsGroup &pt = traj.points[i].groups[gr];
-      time_stamp = cur_joint_pos_map_[pt.group_number].header.stamp;
-      // TODO( ): adjust for more joints
-      group_number = pt.group_number;
       // FS100 requires valid velocity data
-      if (pt.velocities.empty())
+      if (traj.points[i].groups[gr].velocities.empty())
         ROS_ERROR_RETURN(false, "Validation failed: Missing velocity data for trajectory pt %lu", i);
+    }
+  }
 
-      // FS100 requires trajectory start at current position
-      namespace IRC_utils = industrial_robot_client::utils;
+  if (traj.points.empty())
+    return true;
 
-      if (!IRC_utils::isWithinRange(cur_joint_pos_map_[group_number].name, cur_joint_pos_map_[group_number].position,
-                                    traj.joint_names, traj.points[0].groups[gr].positions,
-                                    start_pos_tol_))
-      {
-        ROS_ERROR_RETURN(false, "Validation failed: Trajectory doesn't start at current position.");
-      }
+  // FS100 requires trajectory start at current position
+  namespace IRC_utils = industrial_robot_client::utils;
+  for (int gr = 0; gr < traj.points[0].num_groups; gr++)
+  {
+    const motoman_msgs::DynamicJointsGroup &pt = traj.points[0].groups[gr];
+    const sensor_msgs::JointStateConstPtr cur_pos = get_cur_joint_pos(pt.group_number);
+    if (!cur_pos || ((cur_pos->header.stamp - ros::Time::now()).toSec() > pos_stale_time_))
+      ROS_ERROR_RETURN(false, "Validation failed: Can't get current robot position.");
+
+    if (!IRC_utils::isWithinRange(cur_pos->name, cur_pos->position,
+                                  traj.joint_names, pt.positions, start_pos_tol_))
+    {
+      ROS_ERROR_RETURN(false, "Validation failed: Trajectory doesn't start at current position.");
     }
   }
 
-  if ((time_stamp - ros::Time::now()).toSec() > pos_stale_time_)
-    ROS_ERROR_RETURN(false, "Validation failed: Can't get current robot position.");
-
   return true;
 }
 
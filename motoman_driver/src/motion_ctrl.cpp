@@ -111,6 +111,27 @@ bool MotomanMotionCtrl::stopTrajectory()
   return true;
 }
 
+bool MotomanMotionCtrl::startSequenceCheck()
+{
+  MotionReply reply;
+
+  if (!sendAndReceive(MotionControlCmds::START_SEQUENCE_CHECK, reply))
+  {
+    ROS_ERROR("Failed to send START_SEQUENCE_CHECK command");
+    return false;
+  }
+
+  // older MotoROS versions don't reply to unknown commands with the command number
+  if ((reply.getCommand() != MotionControlCmds::START_SEQUENCE_CHECK) ||
+      (reply.getResult() != MotionReplyResults::SUCCESS))
+  {
+    ROS_WARN_STREAM("Controller does not support the trajectory point sequence check: " << getErrorString(reply));
+    return false;
+  }
+
+  return true;
+}
+
 bool MotomanMotionCtrl::selectToolFile(industrial::shared_types::shared_int group_number,
   industrial::shared_types::shared_int tool_number, std::string& err_msg)
 {
@@ -0,0 +1,163 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLATHEADERS
+#include "motoman_driver/simple_message/joint_traj_pt_full_multi.h"
+#include "motoman_driver/simple_message/motoman_simple_message.h"
+#include "simple_message/shared_types.h"
+#include "simple_message/log_wrapper.h"
+#else
+#include "joint_traj_pt_full_multi.h"  // NOLINT(build/include)
+#include "motoman_simple_message.h"    // NOLINT(build/include)
+#include "shared_types.h"              // NOLINT(build/include)
+#include "log_wrapper.h"               // NOLINT(build/include)
+#endif
+
+#include <cstring>
+
+using industrial::byte_array::ByteArray;
+using industrial::shared_types::shared_int;
+namespace StandardMsgTypes = industrial::simple_message::StandardMsgTypes;
+namespace MotomanMsgTypes = motoman::simple_message::MotomanMsgTypes;
+
+namespace industrial
+{
+namespace joint_traj_pt_full_multi
+{
+
+JointTrajPtFullMulti::JointTrajPtFullMulti(void)
+{
+  this->init();
+}
+JointTrajPtFullMulti::~JointTrajPtFullMulti(void)
+{
+}
+
+void JointTrajPtFullMulti::init()
+{
+  this->num_points_ = 0;
+  this->points_.init();
+}
+
+bool JointTrajPtFullMulti::addPoint(industrial::simple_message::SimpleMessage &msg)
+{
+  if (this->num_points_ >= MAX_NUM_POINTS)
+    return false;
+
+  ByteArray point;
+  if (msg.getMessageType() == MotomanMsgTypes::ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX)
+  {
+    // already has the byte representation of a point
+    point = msg.getData();
+  }
+  else if (msg.getMessageType() == StandardMsgTypes::JOINT_TRAJ_PT_FULL)
+  {
+    // single group point: [robot_id][sequence][group data] becomes [1][sequence][robot_id][group data]
+    ByteArray data = msg.getData();
+    shared_int robot_id, sequence;
+    if (!data.unloadFront(robot_id) || !data.unloadFront(sequence))
+    {
+      LOG_ERROR("Failed to unload joint traj. pt. robot_id and sequence");
+      return false;
+    }
+    point.load(static_cast<shared_int>(1));
+    point.load(sequence);
+    point.load(robot_id);
+    point.load(data);
+  }
+  else
+  {
+    LOG_ERROR("Message type %d is not a joint trajectory point", msg.getMessageType());
+    return false;
+  }
+
+  if (static_cast<shared_int>(this->points_.getBufferSize() + point.getBufferSize()) > MAX_POINTS_SIZE)
+    return false;
+
+  this->points_.load(point);
+  this->num_points_++;
+  return true;
+}
+
+void JointTrajPtFullMulti::copyFrom(JointTrajPtFullMulti &src)
+{
+  this->num_points_ = src.num_points_;
+  this->points_.copyFrom(src.points_);
+}
+
+bool JointTrajPtFullMulti::operator==(JointTrajPtFullMulti &rhs)
+{
+  // the points are compared in their byte representation, as they are sent
+  return this->num_points_ == rhs.num_points_ &&
+         this->points_.getBufferSize() == rhs.points_.getBufferSize() &&
+         memcmp(this->points_.getRawDataPtr(), rhs.points_.getRawDataPtr(), this->points_.getBufferSize()) == 0;
+}
+
+bool JointTrajPtFullMulti::load(industrial::byte_array::ByteArray *buffer)
+{
+  LOG_COMM("Executing joint traj. pt. multi load");
+
+  if (!buffer->load(this->num_points_))
+  {
+    LOG_ERROR("Failed to load joint traj. pt. multi num_points");
+    return false;
+  }
+
+  if (!buffer->load(this->points_))
+  {
+    LOG_ERROR("Failed to load joint traj. pt. multi points");
+    return false;
+  }
+
+  LOG_COMM("Joint traj. pt. multi successfully loaded");
+  return true;
+}
+
+bool JointTrajPtFullMulti::unload(industrial::byte_array::ByteArray *buffer)
+{
+  LOG_COMM("Executing joint traj. pt. multi unload");
+
+  if (!buffer->unloadFront(this->num_points_))
+  {
+    LOG_ERROR("Failed to unload joint traj. pt. multi num_points");
+    return false;
+  }
+
+  // the points don't have a fixed size, they take the rest of the buffer
+  this->points_.copyFrom(*buffer);
+  buffer->init();
+
+  LOG_COMM("Joint traj. pt. multi successfully unloaded");
+  return true;
+}
+
+}  // namespace joint_traj_pt_full_multi
+}  // namespace industrial
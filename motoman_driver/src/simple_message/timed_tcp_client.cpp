@@ -0,0 +1,148 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifndef FLATHEADERS
+#include "motoman_driver/simple_message/timed_tcp_client.h"
+#include "simple_message/byte_array.h"
+#include "simple_message/log_wrapper.h"
+#else
+#include "timed_tcp_client.h"  // NOLINT(build/include)
+#include "byte_array.h"        // NOLINT(build/include)
+#include "log_wrapper.h"       // NOLINT(build/include)
+#endif
+
+using industrial::byte_array::ByteArray;
+using industrial::shared_types::shared_int;
+using industrial::simple_message::SimpleMessage;
+
+namespace industrial
+{
+namespace timed_tcp_client
+{
+
+TimedTcpClient::TimedTcpClient() : reply_timeout_ms_(-1)
+{
+}
+
+TimedTcpClient::~TimedTcpClient()
+{
+}
+
+bool TimedTcpClient::receiveMsg(SimpleMessage &message)
+{
+  if (!this->waitForReply())
+    return false;
+  return TcpClient::receiveMsg(message);
+}
+
+bool TimedTcpClient::receiveMsg(SimpleMessage &message, shared_int timeout_ms)
+{
+  if (!this->waitForReply())
+    return false;
+  return TcpClient::receiveMsg(message, timeout_ms);
+}
+
+void TimedTcpClient::disconnect()
+{
+  // shutdown() instead of close(), makeConnect() closes the old socket when it opens a new one
+  shutdown(this->getSockHandle(), SHUT_RDWR);
+  this->setConnected(false);
+}
+
+bool TimedTcpClient::waitForReply()
+{
+  if (this->reply_timeout_ms_ <= 0 || !this->isConnected())
+    return true;
+
+  const std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(this->reply_timeout_ms_);
+
+  // the length prefix first, then the rest of the message it announces
+  int rc = this->waitForBytes(sizeof(shared_int), deadline);
+  if (rc > 0)
+  {
+    char prefix[sizeof(shared_int)];
+    if (recv(this->getSockHandle(), prefix, sizeof(prefix), MSG_PEEK) == sizeof(prefix))
+    {
+      ByteArray prefix_bytes;
+      shared_int length = 0;
+      prefix_bytes.init(prefix, sizeof(prefix));
+      prefix_bytes.unload(length);
+      // receiving reports a bad length, as it does without a timeout
+      if (length > 0)
+        rc = this->waitForBytes(sizeof(shared_int) + length, deadline);
+    }
+  }
+  const int rcvlowat = 1;
+  setsockopt(this->getSockHandle(), SOL_SOCKET, SO_RCVLOWAT, &rcvlowat, sizeof(rcvlowat));
+
+  if (rc > 0)
+    return true;
+
+  if (rc == 0)
+    LOG_ERROR("No complete reply within %d ms, closing the connection", this->reply_timeout_ms_);
+  else
+    LOG_ERROR("Failed to wait for a reply (%s), closing the connection", strerror(errno));
+  this->disconnect();
+  return false;
+}
+
+int TimedTcpClient::waitForBytes(int num_bytes, const std::chrono::steady_clock::time_point &deadline)
+{
+  // SO_RCVLOWAT keeps poll() from returning for less than num_bytes, instead of once per segment
+  if (setsockopt(this->getSockHandle(), SOL_SOCKET, SO_RCVLOWAT, &num_bytes, sizeof(num_bytes)) < 0)
+    return -1;
+
+  struct pollfd fds;
+  fds.fd = this->getSockHandle();
+  fds.events = POLLIN;
+
+  int rc;
+  do
+  {
+    const int remaining_ms = static_cast<int>(std::max<std::chrono::milliseconds::rep>(
+      0, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count()));
+    fds.revents = 0;
+    rc = poll(&fds, 1, remaining_ms);
+  }
+  while (rc < 0 && errno == EINTR);
+  return rc;
+}
+
+}  // namespace timed_tcp_client
+}  // namespace industrial
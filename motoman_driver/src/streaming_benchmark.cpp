@@ -0,0 +1,728 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ * Copyright (c) 2026, the motoman_driver contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of the copyright holder, nor the names
+ *    of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Streaming benchmark: runs the motion streaming interface and the robot state
+// interface in one process against a (simulated) controller, streams a number
+// of trajectories and prints the results as JSON.
+//
+// Both interfaces get a TcpClient that timestamps the messages going through
+// it, which gives the round trip of every point request, the BUSY replies, how
+// long the streaming thread takes to send the first point of a trajectory and
+// the next point after a reply, and the time each feedback message was read
+// from the socket. The joint_states
+// subscriber matches the published positions to the feedback they came from.
+//
+// usage: see launch/streaming_benchmark.launch
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <ros/ros.h>
+#include <sensor_msgs/JointState.h>
+#include <std_srvs/Trigger.h>
+#include <trajectory_msgs/JointTrajectory.h>
+#include <motoman_msgs/DynamicJointTrajectory.h>
+
+#include "motoman_driver/benchmark_samples.h"
+#include "motoman_driver/industrial_robot_client/motoman_utils.h"
+#include "motoman_driver/industrial_robot_client/robot_group.h"
+#include "motoman_driver/industrial_robot_client/robot_state_interface.h"
+#include "motoman_driver/joint_trajectory_streamer.h"
+#include "motoman_driver/simple_message/messages/motoman_motion_reply_message.h"
+#include "motoman_driver/simple_message/motoman_simple_message.h"
+#include "simple_message/joint_data.h"
+#include "simple_message/messages/joint_feedback_message.h"
+#include "simple_message/simple_message.h"
+#include "simple_message/socket/tcp_client.h"
+
+using industrial::joint_data::JointData;
+using industrial::joint_feedback_message::JointFeedbackMessage;
+using industrial::shared_types::shared_int;
+using industrial::simple_message::SimpleMessage;
+using industrial::tcp_client::TcpClient;
+using motoman::benchmark::Samples;
+using industrial_robot_client::motoman_utils::getJointGroups;
+using industrial_robot_client::robot_state_interface::RobotStateInterface;
+using motoman::joint_trajectory_streamer::MotomanJointTrajectoryStreamer;
+using motoman::simple_message::motion_reply_message::MotionReplyMessage;
+namespace CommTypes = industrial::simple_message::CommTypes;
+namespace MotionReplyResults = motoman::simple_message::motion_reply::MotionReplyResults;
+namespace MotomanMsgTypes = motoman::simple_message::MotomanMsgTypes;
+namespace StandardMsgTypes = industrial::simple_message::StandardMsgTypes;
+
+#define ROS_ERROR_RETURN(rtn, ...) do {ROS_ERROR(__VA_ARGS__); return(rtn);} while (0)  // NOLINT(whitespace/braces)
+
+namespace
+{
+const int DEFAULT_MOTION_PORT = 50240;
+const int DEFAULT_STATE_PORT = 50241;
+const int NUM_JOINTS = 6;  // per group, as on motoros_sim
+const size_t FEEDBACK_HISTORY = 64;  // feedback messages remembered per group for matching them to joint_states
+const double MOTION_THRESHOLD = 1e-4;  // rad a joint has to move before the robot counts as moving
+const double SETTLED_TOLERANCE = 1e-3;  // rad from the end position at which a run is done
+
+/**
+ * \brief Statistics of the point requests sent on the motion connection
+ */
+struct MotionStats
+{
+  MotionStats() : requests(0), busy_replies(0), points_accepted(0) {}
+
+  int requests;         // point messages sent, including resends
+  int busy_replies;
+  int points_accepted;  // a JointTrajPtFullMulti message can carry several
+  ros::Time first_sent;
+  ros::Time last_accepted;
+  ros::Time last_reply;  // of the last point request that was accepted, until the next one is sent
+  Samples round_trip;   // ms
+  Samples reply_to_send;  // ms from accepting a point to sending the next request
+};
+
+/**
+ * \brief Motion connection that times the replies to the trajectory points sent on it
+ */
+class MotionBenchmarkClient : public TcpClient
+{
+public:
+  virtual bool sendMsg(SimpleMessage &message)
+  {
+    const ros::Time now = ros::Time::now();
+    if (!TcpClient::sendMsg(message))
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      pending_.clear();  // the replies of the requests before won't come anymore
+      return false;
+    }
+
+    if (message.getCommType() == CommTypes::SERVICE_REQUEST)
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      pending_.push_back(std::make_pair(message.getMessageType(), now));
+      if (isPointMessage(message.getMessageType()))
+      {
+        if (stats_.requests == 0)
+          stats_.first_sent = now;
+        stats_.requests++;
+        if (!stats_.last_reply.isZero())
+          stats_.reply_to_send.add((now - stats_.last_reply).toSec() * 1000.0);
+        stats_.last_reply = ros::Time();
+      }
+    }
+    return true;
+  }
+
+  virtual bool receiveMsg(SimpleMessage &message)
+  {
+    return receiveMsg(message, -1);
+  }
+
+  virtual bool receiveMsg(SimpleMessage &message, shared_int timeout_ms)
+  {
+    if (!TcpClient::receiveMsg(message, timeout_ms))
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      pending_.clear();
+      return false;
+    }
+
+    const ros::Time now = ros::Time::now();
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    if (message.getMessageType() != MotomanMsgTypes::MOTOMAN_MOTION_REPLY || pending_.empty())
+      return true;
+
+    // replies come in the order of the requests
+    const int request_type = pending_.front().first;
+    const ros::Time sent = pending_.front().second;
+    pending_.pop_front();
+    if (!isPointMessage(request_type))
+      return true;
+
+    stats_.round_trip.add((now - sent).toSec() * 1000.0);
+    MotionReplyMessage reply;
+    if (!reply.init(message))
+      return true;
+
+    int accepted = 0;
+    if (request_type == MotomanMsgTypes::ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI)
+      accepted = static_cast<int>(reply.reply_.getData(0));
+    else if (reply.reply_.getResult() == MotionReplyResults::SUCCESS)
+      accepted = 1;
+
+    if (reply.reply_.getResult() == MotionReplyResults::BUSY)
+      stats_.busy_replies++;
+    if (accepted > 0)
+    {
+      stats_.points_accepted += accepted;
+      stats_.last_accepted = now;
+      // the streaming thread sends the next point right away, after BUSY it waits one interpolation period
+      if (reply.reply_.getResult() != MotionReplyResults::BUSY)
+        stats_.last_reply = now;
+    }
+    return true;
+  }
+
+  int pointsAccepted()
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    return stats_.points_accepted;
+  }
+
+  /**
+   * \brief Returns the statistics collected since the last call
+   */
+  MotionStats takeStats()
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    MotionStats stats = stats_;
+    stats_ = MotionStats();
+    return stats;
+  }
+
+private:
+  static bool isPointMessage(int msg_type)
+  {
+    return msg_type == StandardMsgTypes::JOINT_TRAJ_PT_FULL ||
+           msg_type == MotomanMsgTypes::ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_EX ||
+           msg_type == MotomanMsgTypes::ROS_MSG_MOTO_JOINT_TRAJ_PT_FULL_MULTI;
+  }
+
+  boost::mutex mutex_;
+  std::deque<std::pair<int, ros::Time> > pending_;  // message type and send time of the requests sent
+  MotionStats stats_;
+};
+
+/**
+ * \brief State connection that remembers when the last feedback messages of each group were received
+ */
+class StateBenchmarkClient : public TcpClient
+{
+public:
+  virtual bool receiveMsg(SimpleMessage &message)
+  {
+    return receiveMsg(message, -1);
+  }
+
+  virtual bool receiveMsg(SimpleMessage &message, shared_int timeout_ms)
+  {
+    if (!TcpClient::receiveMsg(message, timeout_ms))
+      return false;
+    if (message.getMessageType() != StandardMsgTypes::JOINT_FEEDBACK)
+      return true;
+
+    const ros::Time now = ros::Time::now();
+    JointFeedbackMessage feedback;
+    JointData positions;
+    if (!feedback.init(message) || !feedback.getPositions(positions))
+      return true;
+
+    Feedback received;
+    received.time = now;
+    for (int i = 0; i < positions.getMaxNumJoints(); ++i)
+      received.positions.push_back(positions.getJoint(i));
+
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    std::deque<Feedback> &history = history_[feedback.getRobotID()];
+    history.push_back(received);
+    if (history.size() > FEEDBACK_HISTORY)
+      history.pop_front();
+    return true;
+  }
+
+  /**
+   * \brief Finds the time the latest feedback of a group with the given positions was received
+   *
+   * \param group group the positions were published for
+   * \param positions published positions, converted from the feedback message
+   * \param time time the feedback message was received
+   *
+   * \return true if feedback with these positions was received recently
+   */
+  bool findReceiveTime(int group, const std::vector<double> &positions, ros::Time *time)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    const std::deque<Feedback> &history = history_[group];
+    for (std::deque<Feedback>::const_reverse_iterator it = history.rbegin(); it != history.rend(); ++it)
+    {
+      bool match = positions.size() <= it->positions.size();
+      for (size_t i = 0; match && i < positions.size(); ++i)
+        match = static_cast<float>(positions[i]) == static_cast<float>(it->positions[i]);
+      if (match)
+      {
+        *time = it->time;
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  struct Feedback
+  {
+    ros::Time time;
+    std::vector<double> positions;
+  };
+
+  boost::mutex mutex_;
+  std::map<int, std::deque<Feedback> > history_;
+};
+
+class StreamingBenchmark
+{
+public:
+  StreamingBenchmark()
+    : pnh_("~"), multi_group_(false), run_active_(false), moved_(false), requests_(0), busy_replies_(0) {}
+
+  bool init()
+  {
+    std::string ip;
+    int motion_port, state_port, num_groups;
+    double connect_timeout;
+    ros::param::param<std::string>("robot_ip_address", ip, "127.0.0.1");
+    pnh_.param("motion_port", motion_port, DEFAULT_MOTION_PORT);
+    pnh_.param("state_port", state_port, DEFAULT_STATE_PORT);
+    pnh_.param("groups", num_groups, 1);
+    pnh_.param("connect_timeout", connect_timeout, 10.0);
+    pnh_.param("num_points", num_points_, 500);
+    pnh_.param("point_period", point_period_, 0.01);
+    pnh_.param("amplitude", amplitude_, 0.2);
+    pnh_.param("runs", num_runs_, 5);
+    pnh_.param("output", output_, std::string());
+    node_.param("streaming_window_size", streaming_window_size_, 1);
+    node_.param("streaming_points_per_message", streaming_points_per_message_, 1);
+
+    if (num_groups < 1 || num_groups > 4)
+      ROS_ERROR_RETURN(false, "groups must be 1 to 4, not %d", num_groups);
+    if (num_points_ < 2 || point_period_ <= 0.0 || num_runs_ < 1)
+      ROS_ERROR_RETURN(false, "num_points must be at least 2, point_period positive and runs at least 1");
+    setDefaultJointNames(num_groups);
+
+    std::map<int, RobotGroup> robot_groups;
+    multi_group_ = getJointGroups("topic_list", robot_groups);
+    if (multi_group_)
+    {
+      for (size_t i = 0; i < robot_groups.size(); ++i)
+      {
+        Group group;
+        group.id = robot_groups[i].get_group_id();
+        group.joint_names = robot_groups[i].get_joint_names();
+        group.topic = robot_groups[i].get_ns() + "/" + robot_groups[i].get_name() + "/joint_states";
+        groups_.push_back(group);
+      }
+    }
+    else
+    {
+      Group group;
+      group.id = 0;
+      node_.getParam("controller_joint_names", group.joint_names);
+      group.topic = "joint_states";
+      groups_.push_back(group);
+    }
+
+    // the controller may still be starting up, which the interfaces don't wait for
+    char* ip_addr = strdup(ip.c_str());  // connection.init() requires "char*", not "const char*"
+    state_connection_.init(ip_addr, state_port);
+    motion_connection_.init(ip_addr, motion_port);
+    free(ip_addr);
+    const ros::Time deadline = ros::Time::now() + ros::Duration(connect_timeout);
+    while (!state_connection_.makeConnect() || !motion_connection_.makeConnect())
+    {
+      if (!ros::ok() || ros::Time::now() > deadline)
+        ROS_ERROR_RETURN(false, "Unable to connect to the controller at '%s'", ip.c_str());
+      ros::Duration(0.5).sleep();
+    }
+
+    if (!state_interface_.init(&state_connection_))
+      ROS_ERROR_RETURN(false, "Failed to initialize the robot state interface");
+    if (!streamer_.init(&motion_connection_))
+      ROS_ERROR_RETURN(false, "Failed to initialize the motion streaming interface");
+
+    for (size_t i = 0; i < groups_.size(); ++i)
+    {
+      subs_.push_back(node_.subscribe<sensor_msgs::JointState>(
+                        groups_[i].topic, 100, boost::bind(&StreamingBenchmark::jointStateCB, this, _1, i)));
+    }
+    if (multi_group_)
+      pub_traj_ = node_.advertise<motoman_msgs::DynamicJointTrajectory>("joint_path_command", 1);
+    else
+      pub_traj_ = node_.advertise<trajectory_msgs::JointTrajectory>("joint_path_command", 1);
+
+    return true;
+  }
+
+  bool run()
+  {
+    boost::thread state_thread(boost::bind(&RobotStateInterface::run, &state_interface_));
+    ros::AsyncSpinner spinner(4);
+    spinner.start();
+
+    const bool ready = waitForController();
+    int failed_runs = 0;
+    for (int run = 0; ready && run < num_runs_ && ros::ok(); ++run)
+    {
+      if (!runOnce())
+      {
+        ROS_WARN("Benchmark run %d failed", run);
+        failed_runs++;
+      }
+    }
+
+    if (ready)
+    {
+      std::ostringstream json;
+      writeJson(json, failed_runs);
+      if (output_.empty())
+      {
+        std::cout << json.str() << std::endl;
+      }
+      else
+      {
+        std::ofstream file(output_.c_str());
+        file << json.str() << std::endl;
+        ROS_INFO("Benchmark results written to '%s'", output_.c_str());
+      }
+    }
+
+    ros::shutdown();
+    state_thread.join();
+    return ready && failed_runs == 0;
+  }
+
+private:
+  struct Group
+  {
+    int id;
+    std::vector<std::string> joint_names;
+    std::string topic;
+    std::vector<double> positions;  // last published
+    std::vector<double> start;      // of the current run
+  };
+
+  // waits for the subscription of the streamer and for the first feedback, and enables the robot
+  bool waitForController()
+  {
+    const ros::Time deadline = ros::Time::now() + ros::Duration(5.0);
+    while (pub_traj_.getNumSubscribers() == 0 || !haveAllPositions())
+    {
+      if (!ros::ok() || ros::Time::now() > deadline)
+        ROS_ERROR_RETURN(false, "No feedback from the controller");
+      ros::Duration(0.01).sleep();
+    }
+
+    std_srvs::Trigger enable;
+    if (!ros::service::call("robot_enable", enable) || !enable.response.success)
+      ROS_ERROR_RETURN(false, "Failed to enable the robot: %s", enable.response.message.c_str());
+    return true;
+  }
+
+  // streams one trajectory from the current position and back, and waits until the robot is there again
+  bool runOnce()
+  {
+    const double duration = (num_points_ - 1) * point_period_;
+    motion_connection_.takeStats();
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      for (size_t i = 0; i < groups_.size(); ++i)
+        groups_[i].start = groups_[i].positions;
+      moved_ = false;
+      run_active_ = true;
+      publish_time_ = ros::Time::now();
+    }
+
+    if (multi_group_)
+      pub_traj_.publish(makeDynamicTrajectory());
+    else
+      pub_traj_.publish(makeTrajectory());
+
+    const ros::Time deadline = publish_time_ + ros::Duration(3.0 * duration + 5.0);
+    bool done = false;
+    while (ros::ok() && !done && ros::Time::now() < deadline)
+    {
+      ros::Duration(0.001).sleep();
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      done = moved_ && motion_connection_.pointsAccepted() >= num_points_ && isSettled();
+    }
+
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    run_active_ = false;
+    const MotionStats stats = motion_connection_.takeStats();
+    requests_ += stats.requests;
+    busy_replies_ += stats.busy_replies;
+    round_trip_.add(stats.round_trip);
+    reply_to_send_.add(stats.reply_to_send);
+    if (stats.requests > 0)
+      publish_to_first_send_.add((stats.first_sent - publish_time_).toSec() * 1000.0);
+    if (moved_)
+      time_to_first_motion_.add((first_motion_time_ - publish_time_).toSec() * 1000.0);
+    if (stats.points_accepted > 1 && stats.last_accepted > stats.first_sent)
+      points_per_sec_.add(stats.points_accepted / (stats.last_accepted - stats.first_sent).toSec());
+
+    if (!done)
+      ROS_WARN("Run timed out after %d of %d points", stats.points_accepted, num_points_);
+    return done;
+  }
+
+  // position, velocity and acceleration of a joint at time t of a trajectory from start and back
+  void sample(double start, double t, double *pos, double *vel, double *acc) const
+  {
+    const double w = 2.0 * M_PI / ((num_points_ - 1) * point_period_);
+    *pos = start + 0.5 * amplitude_ * (1.0 - std::cos(w * t));
+    *vel = 0.5 * amplitude_ * w * std::sin(w * t);
+    *acc = 0.5 * amplitude_ * w * w * std::cos(w * t);
+  }
+
+  trajectory_msgs::JointTrajectory makeTrajectory()
+  {
+    trajectory_msgs::JointTrajectory traj;
+    traj.header.stamp = ros::Time::now();
+    traj.joint_names = groups_[0].joint_names;
+    traj.points.resize(num_points_);
+    for (int p = 0; p < num_points_; ++p)
+    {
+      trajectory_msgs::JointTrajectoryPoint &pt = traj.points[p];
+      const double t = p * point_period_;
+      const size_t num_joints = groups_[0].joint_names.size();
+      pt.positions.resize(num_joints);
+      pt.velocities.resize(num_joints);
+      pt.accelerations.resize(num_joints);
+      for (size_t j = 0; j < num_joints; ++j)
+        sample(groups_[0].start[j], t, &pt.positions[j], &pt.velocities[j], &pt.accelerations[j]);
+      pt.time_from_start = ros::Duration(t);
+    }
+    return traj;
+  }
+
+  motoman_msgs::DynamicJointTrajectory makeDynamicTrajectory()
+  {
+    motoman_msgs::DynamicJointTrajectory traj;
+    traj.header.stamp = ros::Time::now();
+    for (size_t g = 0; g < groups_.size(); ++g)
+      traj.joint_names.insert(traj.joint_names.end(), groups_[g].joint_names.begin(), groups_[g].joint_names.end());
+    traj.points.resize(num_points_);
+    for (int p = 0; p < num_points_; ++p)
+    {
+      motoman_msgs::DynamicJointPoint &pt = traj.points[p];
+      const double t = p * point_period_;
+      pt.num_groups = groups_.size();
+      pt.groups.resize(groups_.size());
+      for (size_t g = 0; g < groups_.size(); ++g)
+      {
+        motoman_msgs::DynamicJointsGroup &group = pt.groups[g];
+        const size_t num_joints = groups_[g].joint_names.size();
+        group.group_number = groups_[g].id;
+        group.num_joints = num_joints;
+        group.positions.resize(num_joints);
+        group.velocities.resize(num_joints);
+        group.accelerations.resize(num_joints);
+        group.effort.resize(num_joints, 0.0);
+        for (size_t j = 0; j < num_joints; ++j)
+          sample(groups_[g].start[j], t, &group.positions[j], &group.velocities[j], &group.accelerations[j]);
+        group.time_from_start = ros::Duration(t);
+      }
+    }
+    return traj;
+  }
+
+  void jointStateCB(const sensor_msgs::JointStateConstPtr &msg, size_t group_idx)
+  {
+    const ros::Time now = ros::Time::now();
+    Group &group = groups_[group_idx];
+
+    ros::Time received;
+    const bool found = state_connection_.findReceiveTime(group.id, msg->position, &received);
+
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    group.positions = msg->position;
+    if (!run_active_)
+      return;
+
+    if (found)
+      feedback_to_publish_.add((msg->header.stamp - received).toSec() * 1000.0);
+    feedback_delivery_.add((now - msg->header.stamp).toSec() * 1000.0);
+
+    if (!moved_ && group.start.size() == group.positions.size())
+    {
+      for (size_t j = 0; j < group.positions.size() && !moved_; ++j)
+        moved_ = std::fabs(group.positions[j] - group.start[j]) > MOTION_THRESHOLD;
+      if (moved_)
+        first_motion_time_ = now;
+    }
+  }
+
+  bool haveAllPositions()
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    for (size_t i = 0; i < groups_.size(); ++i)
+    {
+      if (groups_[i].positions.size() != groups_[i].joint_names.size())
+        return false;
+    }
+    return true;
+  }
+
+  // requires mutex_
+  bool isSettled() const
+  {
+    for (size_t i = 0; i < groups_.size(); ++i)
+    {
+      for (size_t j = 0; j < groups_[i].positions.size(); ++j)
+      {
+        if (std::fabs(groups_[i].positions[j] - groups_[i].start[j]) > SETTLED_TOLERANCE)
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // joint names like those of motoros_sim, unless the configuration has them
+  void setDefaultJointNames(int num_groups)
+  {
+    if (node_.hasParam("topic_list") || (num_groups == 1 && node_.hasParam("controller_joint_names")))
+      return;
+
+    XmlRpc::XmlRpcValue topic_list;
+    for (int g = 0; g < num_groups; ++g)
+    {
+      std::ostringstream prefix;
+      prefix << "r" << g + 1;
+      XmlRpc::XmlRpcValue joints;
+      for (int j = 0; j < NUM_JOINTS; ++j)
+      {
+        std::ostringstream name;
+        name << (num_groups > 1 ? prefix.str() + "_" : std::string()) << "joint_" << j + 1;
+        joints[j] = name.str();
+      }
+
+      if (num_groups == 1)
+      {
+        node_.setParam("controller_joint_names", joints);
+        return;
+      }
+      topic_list[g]["name"] = prefix.str() + "_controller";
+      topic_list[g]["ns"] = std::string("benchmark");
+      topic_list[g]["group"] = g;
+      topic_list[g]["joints"] = joints;
+    }
+    node_.setParam("topic_list", topic_list);
+  }
+
+  void writeJson(std::ostream &os, int failed_runs)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    os << std::fixed << std::setprecision(3);
+    os << "{\n"
+       << "  \"benchmark\": \"motion_streaming\",\n"
+       << "  \"stamp\": " << ros::WallTime::now().toSec() << ",\n"
+       << "  \"config\": {"
+       << "\"groups\": " << groups_.size()
+       << ", \"num_points\": " << num_points_
+       << ", \"point_period\": " << point_period_
+       << ", \"runs\": " << num_runs_
+       << ", \"streaming_window_size\": " << streaming_window_size_
+       << ", \"streaming_points_per_message\": " << streaming_points_per_message_ << "},\n"
+       << "  \"failed_runs\": " << failed_runs << ",\n"
+       << "  \"point_requests\": " << requests_ << ",\n"
+       << "  \"busy_replies\": " << busy_replies_ << ",\n"
+       << "  \"busy_retry_rate\": " << (requests_ > 0 ? static_cast<double>(busy_replies_) / requests_ : 0.0)
+       << ",\n";
+    os << "  \"points_per_sec\": ";
+    points_per_sec_.toJson(os);
+    os << ",\n  \"point_round_trip_ms\": ";
+    round_trip_.toJson(os);
+    os << ",\n  \"publish_to_first_send_ms\": ";
+    publish_to_first_send_.toJson(os);
+    os << ",\n  \"reply_to_next_send_ms\": ";
+    reply_to_send_.toJson(os);
+    os << ",\n  \"time_to_first_motion_ms\": ";
+    time_to_first_motion_.toJson(os);
+    os << ",\n  \"feedback_to_publish_ms\": ";
+    feedback_to_publish_.toJson(os);
+    os << ",\n  \"publish_to_subscriber_ms\": ";
+    feedback_delivery_.toJson(os);
+    os << "\n}";
+  }
+
+  ros::NodeHandle node_;
+  ros::NodeHandle pnh_;
+  MotionBenchmarkClient motion_connection_;
+  StateBenchmarkClient state_connection_;
+  MotomanJointTrajectoryStreamer streamer_;
+  RobotStateInterface state_interface_;
+  std::vector<ros::Subscriber> subs_;
+  ros::Publisher pub_traj_;
+
+  bool multi_group_;
+  int num_points_;
+  double point_period_;
+  double amplitude_;
+  int num_runs_;
+  std::string output_;
+  int streaming_window_size_;
+  int streaming_points_per_message_;
+
+  boost::mutex mutex_;  // protects the members below and the positions of groups_
+  std::vector<Group> groups_;
+  bool run_active_;
+  bool moved_;
+  ros::Time publish_time_;
+  ros::Time first_motion_time_;
+  int requests_;
+  int busy_replies_;
+  Samples points_per_sec_;
+  Samples round_trip_;
+  Samples publish_to_first_send_;
+  Samples reply_to_send_;
+  Samples time_to_first_motion_;
+  Samples feedback_to_publish_;
+  Samples feedback_delivery_;
+};
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "streaming_benchmark");
+
+  StreamingBenchmark benchmark;
+  if (!benchmark.init())
+    return 1;
+  return benchmark.run() ? 0 : 1;
+}